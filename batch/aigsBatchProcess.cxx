@@ -0,0 +1,153 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: aigsBatchProcess.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "sessionProcessing.h"
+#include "threadPool.h"
+
+// C++ includes
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+void printUsage(const char *prog)
+{
+  std::cerr << "Usage: " << prog << " <session directory> [options]\n"
+    << "  --threads <n>            worker threads (default: one per core)\n"
+    << "  --report <file.csv>      summary report (default: stdout)\n"
+    << "  --fiducials <file.xyz>   model fiducials for sessions without a fiducials.xyz\n"
+    << "\n"
+    << "Each sub-directory holding a pivot.txt is processed as one session.\n";
+}
+} // namespace
+
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+    {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  std::string root = argv[1], reportFile, fiducialFile;
+  int numThreads = 0;
+
+  for (int i = 2; i < argc; i++)
+    {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1 < argc);
+
+    if (arg == "--threads" && hasValue)
+      numThreads = std::atoi(argv[++i]);
+    else if (arg == "--report" && hasValue)
+      reportFile = argv[++i];
+    else if (arg == "--fiducials" && hasValue)
+      fiducialFile = argv[++i];
+    else
+      {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::vector<pointType> defaultFiducials;
+  if (!fiducialFile.empty() && !readPointFile(fiducialFile, defaultFiducials))
+    {
+    std::cerr << "Cannot read " << fiducialFile << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector<std::string> sessions = findSessions(root);
+  if (sessions.empty())
+    {
+    std::cerr << "No sessions found in " << root << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  auto t0 = std::chrono::steady_clock::now();
+
+  // sessions are independent: each worker pulls the next unprocessed one
+  std::vector<sessionResult> results(sessions.size());
+  threadPool pool(numThreads);
+  pool.parallelFor(sessions.size(), [&](size_t begin, size_t end)
+    {
+    for (size_t i = begin; i < end; i++)
+      results[i] = processSession(sessions[i], defaultFiducials);
+    });
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  if (reportFile.empty())
+    {
+    writeSessionReport(std::cout, results);
+    }
+  else
+    {
+    std::ofstream os(reportFile.c_str());
+    if (!os)
+      {
+      std::cerr << "Cannot write " << reportFile << std::endl;
+      return EXIT_FAILURE;
+      }
+    writeSessionReport(os, results);
+    }
+
+  int numFailed = 0;
+  for (const sessionResult &r : results)
+    numFailed += r.ok ? 0 : 1;
+
+  std::cerr << sessions.size() << " sessions (" << numFailed << " failed) in "
+    << elapsed << " s on " << pool.getNumberOfThreads() << " threads, "
+    << sessions.size() / elapsed << " sessions/s" << std::endl;
+
+  return numFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
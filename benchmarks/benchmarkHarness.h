@@ -0,0 +1,186 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: benchmarkHarness.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __BENCHMARKHARNESS_H__
+#define __BENCHMARKHARNESS_H__
+
+#pragma once
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*!
+* Minimal micro-benchmark runner.
+*
+* Each benchmark is run a few times to warm up, then timed over a fixed number
+* of iterations. Results are written as JSON so that runs can be diffed across
+* releases.
+*/
+class benchmarkRunner
+{
+public:
+  struct result
+    {
+    std::string           name;
+    std::vector<double>   samplesMs;
+    std::vector< std::pair<std::string, double> > counters;
+    };
+
+  benchmarkRunner(int iter = 50, int warm = 3) : iterations(iter), warmUp(warm) {}
+
+  void setIterations(int iter) { iterations = iter; }
+
+  //! only run benchmarks whose name contains this string (empty: run all)
+  void setFilter(const std::string &f) { filter = f; }
+
+  /*!
+  * Time body() iterations times. setup() is called before every iteration and
+  * is not included in the timing.
+  */
+  result *run(const std::string &name, std::function<void()> body,
+    std::function<void()> setup = std::function<void()>())
+  {
+    if (!filter.empty() && name.find(filter) == std::string::npos)
+      return nullptr;
+
+    for (int i = 0; i < warmUp; i++)
+      {
+      if (setup)
+        setup();
+      body();
+      }
+
+    result r;
+    r.name = name;
+    r.samplesMs.reserve(iterations);
+    for (int i = 0; i < iterations; i++)
+      {
+      if (setup)
+        setup();
+      auto t0 = std::chrono::steady_clock::now();
+      body();
+      auto t1 = std::chrono::steady_clock::now();
+      r.samplesMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+      }
+
+    results.push_back(r);
+    return &results.back();
+  }
+
+  //! write all results as JSON
+  void writeJSON(std::ostream &os, const std::string &versionString) const
+  {
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    os << std::setprecision(6) << std::fixed;
+    os << "{\n";
+    os << "  \"context\": {\n";
+    os << "    \"date\": \"" << date << "\",\n";
+    os << "    \"vtk_version\": \"" << versionString << "\",\n";
+    os << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n";
+    os << "    \"iterations\": " << iterations << "\n";
+    os << "  },\n";
+    os << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); i++)
+      {
+      std::vector<double> s = results[i].samplesMs;
+      std::sort(s.begin(), s.end());
+
+      double mean = 0.0;
+      for (double v : s)
+        mean += v;
+      mean /= s.size();
+      double var = 0.0;
+      for (double v : s)
+        var += (v - mean) * (v - mean);
+      var = s.size() > 1 ? var / (s.size() - 1) : 0.0;
+
+      os << (i ? ",\n" : "\n");
+      os << "    {\n";
+      os << "      \"name\": \"" << results[i].name << "\",\n";
+      os << "      \"iterations\": " << s.size() << ",\n";
+      os << "      \"mean_ms\": " << mean << ",\n";
+      os << "      \"median_ms\": " << percentile(s, 0.5) << ",\n";
+      os << "      \"p95_ms\": " << percentile(s, 0.95) << ",\n";
+      os << "      \"min_ms\": " << s.front() << ",\n";
+      os << "      \"max_ms\": " << s.back() << ",\n";
+      os << "      \"stddev_ms\": " << std::sqrt(var);
+      for (auto &c : results[i].counters)
+        os << ",\n      \"" << c.first << "\": " << c.second;
+      os << "\n    }";
+      }
+
+    os << "\n  ]\n}\n";
+  }
+
+private:
+  static double percentile(const std::vector<double> &sorted, double p)
+  {
+    double pos = p * (sorted.size() - 1);
+    size_t lo = (size_t)pos;
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+  }
+
+  std::deque<result>  results; // stable addresses for run()'s return value
+  std::string         filter;
+  int                 iterations, warmUp;
+};
+
+#endif // of __BENCHMARKHARNESS_H__
@@ -0,0 +1,1000 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: hotPathBenchmarks.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "benchmarkHarness.h"
+#include "dataIO.h"
+#include "isoSurfaceExtractor.h"
+#include "meshBatcher.h"
+#include "ndiBinaryClient.h"
+#include "ndiProtocol.h"
+#include "pivotCalibration.h"
+#include "planeMeshSlicer.h"
+#include "toolTrail.h"
+#include "traceRecorder.h"
+#include "trackerStatusDrawing.h"
+#include "trackingStatistics.h"
+#include "treEstimator.h"
+#include "usReconstructor.h"
+
+#ifdef AIGS_WITH_NDI_EMULATOR
+#include "ndiEmulator.h"
+#endif
+
+// VTK includes
+#include <vtkActor.h>
+#include <vtkActorCollection.h>
+#include <vtkCamera.h>
+#include <vtkCoordinate.h>
+#include <vtkImageCanvasSource2D.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkLogoRepresentation.h>
+#include <vtkMetaImageWriter.h>
+#include <vtkNew.h>
+#include <vtkPLYWriter.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkPolyDataWriter.h>
+#include <vtkProperty.h>
+#include <vtkProperty2D.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkSTLWriter.h>
+#include <vtkShortArray.h>
+#include <vtkSphereSource.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkTransform.h>
+#include <vtkTriangleFilter.h>
+#include <vtkVersion.h>
+#include <vtkXMLPolyDataWriter.h>
+
+// C++ includes
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+struct benchmarkOptions
+  {
+  std::string outputFile;
+  std::string workDir = ".";
+  std::string filter;
+  int         iterations = 50;
+  int         numTools = 8;
+  int         meshResolution = 400;  // ~320k triangles
+  int         volumeSize = 128;
+  int         numPivotPoses = 2000;
+  int         numUSFrames = 150;
+  int         numStructures = 200;
+  bool        render = true;
+  };
+
+
+void printUsage(const char *prog)
+{
+  std::cerr << "Usage: " << prog << " [options]\n"
+    << "  --output <file.json>      write results to file (default: stdout)\n"
+    << "  --work-dir <dir>          where the synthetic data files are written (default: .)\n"
+    << "  --filter <substring>      only run benchmarks whose name contains substring\n"
+    << "  --iterations <n>          timed iterations per benchmark (default: 50)\n"
+    << "  --tools <n>               number of simulated tracked tools (default: 8)\n"
+    << "  --mesh-resolution <n>     sphere theta/phi resolution of the test mesh (default: 400)\n"
+    << "  --volume-size <n>         edge length in voxels of the test volume (default: 128)\n"
+    << "  --pivot-poses <n>         poses per pivot calibration (default: 2000)\n"
+    << "  --us-frames <n>           640x480 frames per ultrasound reconstruction (default: 150)\n"
+    << "  --structures <n>          number of segmented structures in the scene (default: 200)\n"
+    << "  --no-render               skip benchmarks that need an OpenGL context\n";
+}
+
+
+bool parseArguments(int argc, char *argv[], benchmarkOptions &opt)
+{
+  for (int i = 1; i < argc; i++)
+    {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1 < argc);
+
+    if (arg == "--output" && hasValue)
+      opt.outputFile = argv[++i];
+    else if (arg == "--work-dir" && hasValue)
+      opt.workDir = argv[++i];
+    else if (arg == "--filter" && hasValue)
+      opt.filter = argv[++i];
+    else if (arg == "--iterations" && hasValue)
+      opt.iterations = std::atoi(argv[++i]);
+    else if (arg == "--tools" && hasValue)
+      opt.numTools = std::atoi(argv[++i]);
+    else if (arg == "--mesh-resolution" && hasValue)
+      opt.meshResolution = std::atoi(argv[++i]);
+    else if (arg == "--volume-size" && hasValue)
+      opt.volumeSize = std::atoi(argv[++i]);
+    else if (arg == "--pivot-poses" && hasValue)
+      opt.numPivotPoses = std::atoi(argv[++i]);
+    else if (arg == "--us-frames" && hasValue)
+      opt.numUSFrames = std::atoi(argv[++i]);
+    else if (arg == "--structures" && hasValue)
+      opt.numStructures = std::atoi(argv[++i]);
+    else if (arg == "--no-render")
+      opt.render = false;
+    else
+      return false;
+    }
+
+  return opt.iterations > 0 && opt.numTools > 0 && opt.meshResolution > 2 &&
+    opt.volumeSize > 1 && opt.numPivotPoses > 1 && opt.numUSFrames > 0 &&
+    opt.numStructures > 0;
+}
+
+
+// write the polydata as a Wavefront .obj (triangles only)
+void writeOBJ(vtkPolyData *data, const std::string &fname)
+{
+  std::ofstream os(fname.c_str());
+  double p[3];
+  for (vtkIdType i = 0; i < data->GetNumberOfPoints(); i++)
+    {
+    data->GetPoint(i, p);
+    os << "v " << p[0] << " " << p[1] << " " << p[2] << "\n";
+    }
+
+  vtkIdType npts, *pts;
+  vtkCellArray *polys = data->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); )
+    {
+    os << "f";
+    for (vtkIdType j = 0; j < npts; j++)
+      os << " " << pts[j] + 1;
+    os << "\n";
+    }
+}
+
+
+// write the volume as a raw, uncompressed .nrrd with an attached header
+void writeNRRD(vtkImageData *image, const std::string &fname)
+{
+  int dims[3];
+  double spacing[3];
+  image->GetDimensions(dims);
+  image->GetSpacing(spacing);
+
+  std::ofstream os(fname.c_str(), std::ios::binary);
+  os << "NRRD0004\n"
+    << "type: short\n"
+    << "dimension: 3\n"
+    << "sizes: " << dims[0] << " " << dims[1] << " " << dims[2] << "\n"
+    << "spacings: " << spacing[0] << " " << spacing[1] << " " << spacing[2] << "\n"
+    << "encoding: raw\n"
+    << "endian: little\n\n";
+  os.write(static_cast<const char *>(image->GetScalarPointer()),
+    (std::streamsize)dims[0] * dims[1] * dims[2] * sizeof(short));
+}
+
+
+// a CT-like volume: a dense sphere in air
+vtkSmartPointer<vtkImageData> createTestVolume(int n)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(n, n, n);
+  image->SetSpacing(1.0, 1.0, 1.0);
+  image->AllocateScalars(VTK_SHORT, 1);
+
+  short *ptr = static_cast<short *>(image->GetScalarPointer());
+  double c = 0.5 * (n - 1), r = 0.4 * n;
+  for (int z = 0; z < n; z++)
+    for (int y = 0; y < n; y++)
+      for (int x = 0; x < n; x++)
+        {
+        double d = std::sqrt((x - c)*(x - c) + (y - c)*(y - c) + (z - c)*(z - c));
+        *ptr++ = (short)(d < r ? 1000.0 - 2.0 * d : -1000.0);
+        }
+
+  return image;
+}
+
+
+// poses of a stylus pivoting about a fixed point, with 0.25 mm of tracker noise
+std::vector< std::vector<double> > createPivotPoses(int nPoses)
+{
+  const double tip[3] = { 0.5, -1.0, 160.0 };
+  const double pivot[3] = { 20.0, 35.0, -1200.0 };
+
+  std::mt19937 gen(42);
+  std::normal_distribution<double> normal(0.0, 1.0);
+  std::vector< std::vector<double> > poses(nPoses, std::vector<double>(16, 0.0));
+
+  for (int k = 0; k < nPoses; k++)
+    {
+    // random rotation (axis/angle) up to about 30 degrees
+    double a[3] = { normal(gen), normal(gen), normal(gen) };
+    double l = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    double theta = 0.5 * normal(gen);
+    double c = std::cos(theta), s = std::sin(theta), C = 1.0 - c;
+    a[0] /= l; a[1] /= l; a[2] /= l;
+
+    double R[3][3] = {
+      { c + a[0] * a[0] * C, a[0] * a[1] * C - a[2] * s, a[0] * a[2] * C + a[1] * s },
+      { a[1] * a[0] * C + a[2] * s, c + a[1] * a[1] * C, a[1] * a[2] * C - a[0] * s },
+      { a[2] * a[0] * C - a[1] * s, a[2] * a[1] * C + a[0] * s, c + a[2] * a[2] * C } };
+
+    std::vector<double> &m = poses[k];
+    for (int r = 0; r < 3; r++)
+      {
+      for (int j = 0; j < 3; j++)
+        m[4 * r + j] = R[r][j];
+      m[4 * r + 3] = pivot[r] - (R[r][0] * tip[0] + R[r][1] * tip[1] + R[r][2] * tip[2]) +
+        0.25 * normal(gen);
+      }
+    m[15] = 1.0;
+    }
+
+  return poses;
+}
+
+
+/*!
+* Stands in for myTracker->Update() and the vtkTrackerTool accessors read by
+* basic_QtVTK::updateTrackerInfo(): every update() is one tracker sample at
+* 60 Hz, with a new pose, status and time stamp per tool. Tools drop out now
+* and then, like a tool leaving the field of view.
+*/
+struct simulatedToolSet
+  {
+  struct tool
+    {
+    vtkSmartPointer<vtkTransform> transform;
+    enumTrackerToolStatus         status = enToolOK;
+    double                        timeStamp = 0.0;
+    };
+
+  explicit simulatedToolSet(int n) : tools(n), time(0.0), rng(11), jitter(0.0, 0.05)
+    {
+    for (tool &t : tools)
+      t.transform = vtkSmartPointer<vtkTransform>::New();
+    }
+
+  void update()
+    {
+    time += 1.0 / 60.0;
+    std::uniform_int_distribution<int> dropout(0, 299);
+    for (size_t i = 0; i < tools.size(); i++)
+      {
+      tool &t = tools[i];
+      t.status = dropout(rng) == 0 ? enToolMissing : enToolOK;
+      t.timeStamp = time;
+      t.transform->Identity();
+      t.transform->Translate(50.0 * std::cos(time + i) + jitter(rng), 50.0 * std::sin(time + i) + jitter(rng),
+        100.0 * i + jitter(rng));
+      t.transform->RotateZ(10.0 * time);
+      }
+    }
+
+  std::vector<tool>                 tools;
+  double                            time;
+  std::mt19937                      rng;
+  std::normal_distribution<double>  jitter;
+  };
+
+
+// same geometry as basic_QtVTK::createTrackerLogo()
+void setupTrackerCanvas(vtkImageCanvasSource2D *canvas, int nObjects, int logoWidgetX, int logoWidgetY)
+{
+  canvas->SetScalarTypeToUnsignedChar();
+  canvas->SetNumberOfScalarComponents(3);
+  canvas->SetExtent(0, logoWidgetX*nObjects + nObjects, 0, logoWidgetY + 2, 0, 0);
+  canvas->SetDrawColor(255, 255, 255);
+  canvas->FillBox(0, logoWidgetX*nObjects + nObjects, 0, logoWidgetY + 2);
+  canvas->Update();
+}
+} // namespace
+
+
+int main(int argc, char *argv[])
+{
+  benchmarkOptions opt;
+  if (!parseArguments(argc, argv, opt))
+    {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  benchmarkRunner runner(opt.iterations);
+  runner.setFilter(opt.filter);
+  benchmarkRunner::result *r;
+
+  //
+  // one tick of basic_QtVTK::updateTrackerInfo() with a simulated tool set: the
+  // tracker update, then per tool the status box, the statistics sample and, for
+  // the stylus (tool 0), the trail; the statistics text twice a second; and the
+  // logo canvas update. Every tick brings a new sample of every tool.
+  //
+  const int logoWidgetX = 16, logoWidgetY = 10;
+  vtkNew<vtkImageCanvasSource2D> trackerDrawing;
+  setupTrackerCanvas(trackerDrawing, opt.numTools, logoWidgetX, logoWidgetY);
+  simulatedToolSet toolSet(opt.numTools);
+  std::vector<toolStatistics> tickStats(opt.numTools);
+  std::vector<double> tickLastTimeStamp(opt.numTools, -1.0);
+  toolTrail tickTrail;
+  std::string tickText;
+  double tickTextTime = 0.0;
+
+  auto trackerTick = [&]()
+    {
+    toolSet.update();
+
+    for (int i = 0; i < opt.numTools; i++)
+      {
+      const simulatedToolSet::tool &t = toolSet.tools[i];
+      drawTrackerToolStatus(trackerDrawing, i, t.status, logoWidgetX, logoWidgetY);
+
+      if (t.timeStamp != tickLastTimeStamp[i])
+        {
+        tickLastTimeStamp[i] = t.timeStamp;
+        double pos[3];
+        t.transform->GetPosition(pos);
+        tickStats[i].addSample(t.timeStamp, t.status, pos);
+        if (i == 0)
+          {
+          if (t.status == enToolOK)
+            tickTrail.addPoint(t.timeStamp, pos);
+          else
+            tickTrail.breakTrail();
+          }
+        }
+      }
+    tickTrail.update(toolSet.time);
+
+    if (toolSet.time - tickTextTime > 0.5)
+      {
+      tickTextTime = toolSet.time;
+      std::ostringstream os;
+      for (int i = 0; i < opt.numTools; i++)
+        {
+        toolStatistics::summary s = tickStats[i].getSummary(toolSet.time);
+        os << i << ": " << s.sampleRateHz << " Hz  dt p95 " << s.intervalP95Ms << " ms  jitter "
+          << s.jitterRMS << " mm  drops " << s.dropouts << "\n";
+        }
+      tickText = os.str();
+      }
+
+    trackerDrawing->Update();
+    };
+
+  r = runner.run("updateTrackerInfo/tick", trackerTick);
+  if (r)
+    r->counters.push_back(std::make_pair("tools", (double)opt.numTools));
+
+  //
+  // synthetic mesh, written once in every format readAnPolyData is used for
+  //
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.0);
+  sphere->SetThetaResolution(opt.meshResolution);
+  sphere->SetPhiResolution(opt.meshResolution);
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputConnection(sphere->GetOutputPort());
+  triangles->Update();
+  vtkPolyData *mesh = triangles->GetOutput();
+
+  std::string meshBase = opt.workDir + "/benchmark_mesh";
+  {
+    vtkNew<vtkPolyDataWriter> w;
+    w->SetFileName((meshBase + ".vtk").c_str());
+    w->SetFileTypeToBinary();
+    w->SetInputData(mesh);
+    w->Write();
+  }
+  {
+    vtkNew<vtkSTLWriter> w;
+    w->SetFileName((meshBase + ".stl").c_str());
+    w->SetFileTypeToBinary();
+    w->SetInputData(mesh);
+    w->Write();
+  }
+  {
+    vtkNew<vtkPLYWriter> w;
+    w->SetFileName((meshBase + ".ply").c_str());
+    w->SetFileTypeToBinary();
+    w->SetInputData(mesh);
+    w->Write();
+  }
+  {
+    vtkNew<vtkXMLPolyDataWriter> w;
+    w->SetFileName((meshBase + ".vtp").c_str());
+    w->SetInputData(mesh);
+    w->Write();
+  }
+  writeOBJ(mesh, meshBase + ".obj");
+
+  const char *meshTypes[] = { "vtk", "stl", "ply", "obj", "vtp" };
+  for (const char *ext : meshTypes)
+    {
+    std::string fname = meshBase + "." + ext;
+    vtkIdType nCells = 0;
+    r = runner.run(std::string("readAnPolyData/") + ext, [&]()
+      {
+      vtkSmartPointer<vtkPolyData> data = readMeshFile(fname);
+      nCells = data ? data->GetNumberOfCells() : 0;
+      });
+    if (r)
+      r->counters.push_back(std::make_pair("cells", (double)nCells));
+    }
+
+  //
+  // synthetic volume, written in every format loadVolume supports
+  //
+  vtkSmartPointer<vtkImageData> testVolume = createTestVolume(opt.volumeSize);
+  std::string volumeBase = opt.workDir + "/benchmark_volume";
+  {
+    vtkNew<vtkMetaImageWriter> w;
+    w->SetFileName((volumeBase + ".mhd").c_str());
+    w->SetCompression(false);
+    w->SetInputData(testVolume);
+    w->Write();
+  }
+  writeNRRD(testVolume, volumeBase + ".nrrd");
+
+  const char *volumeTypes[] = { "mhd", "nrrd" };
+  for (const char *ext : volumeTypes)
+    {
+    std::string fname = volumeBase + "." + ext;
+    r = runner.run(std::string("loadVolume/") + ext, [&]()
+      {
+      vtkNew<vtkImageData> imageData;
+      readVolumeFile(fname, imageData);
+      });
+    if (r)
+      r->counters.push_back(std::make_pair("voxels", std::pow((double)opt.volumeSize, 3.0)));
+    }
+
+  //
+  // iso-surface of the test volume: a fresh threshold each time (cache miss),
+  // then a threshold already extracted (cache hit)
+  //
+  isoSurfaceExtractor isoSurface;
+  isoSurface.setInput(testVolume);
+  int isoCount = 0;
+  vtkSmartPointer<vtkPolyData> isoMesh;
+  r = runner.run("isoSurface/extract", [&]()
+    {
+    isoMesh = isoSurface.extract(100.0 + isoCount++);
+    });
+  if (r)
+    {
+    isoSurfaceExtractor::statistics s = isoSurface.getStatistics();
+    r->counters.push_back(std::make_pair("voxels", std::pow((double)opt.volumeSize, 3.0)));
+    r->counters.push_back(std::make_pair("triangles", (double)s.numTriangles));
+    }
+
+  r = runner.run("isoSurface/cached", [&]()
+    {
+    isoMesh = isoSurface.extract(100.0);
+    });
+  isoSurface.setInput(nullptr);
+
+  //
+  // tracking statistics: one sample per tracker update, a 60 Hz static tool with
+  // 0.05 mm of jitter and a dropout every 500 samples
+  //
+  toolStatistics toolStats;
+  std::mt19937 statsRng(7);
+  std::normal_distribution<double> jitter(0.0, 0.05);
+  long long statsSample = 0;
+  r = runner.run("trackingStatistics/addSample", [&]()
+    {
+    for (int k = 0; k < 1000; k++, statsSample++)
+      {
+      double pos[3] = { 10.0 + jitter(statsRng), 20.0 + jitter(statsRng), 30.0 + jitter(statsRng) };
+      enumTrackerToolStatus status = (statsSample % 500 == 0) ? enToolMissing : enToolOK;
+      toolStats.addSample(statsSample / 60.0, status, pos);
+      }
+    });
+  if (r)
+    {
+    toolStatistics::summary s = toolStats.getSummary((statsSample - 1) / 60.0);
+    r->counters.push_back(std::make_pair("samples_per_iteration", 1000.0));
+    r->counters.push_back(std::make_pair("rate_hz", s.sampleRateHz));
+    r->counters.push_back(std::make_pair("pooled_sigma_mm", s.pooledSigma));
+    }
+
+  //
+  // trace markers: 1000 scopes, with the recorder off and on
+  //
+  const char *traceBenchmarks[] = { "trace/scopeDisabled", "trace/scopeEnabled" };
+  for (int k = 0; k < 2; k++)
+    {
+    traceRecorder::setEnabled(k == 1);
+    r = runner.run(traceBenchmarks[k], [&]()
+      {
+      for (int i = 0; i < 1000; i++)
+        {
+        AIGS_TRACE_SCOPE("benchmark");
+        }
+      });
+    if (r)
+      r->counters.push_back(std::make_pair("scopes_per_iteration", 1000.0));
+    }
+  traceRecorder::setEnabled(false);
+  traceRecorder::clear();
+
+  //
+  // stylus trail: one tracker tick (one sample and an update) on top of a trail
+  // of a million points, a helix with 0.2 mm between samples
+  //
+  toolTrail trail;
+  double trailTime = 0.0;
+  auto addTrailSample = [&]()
+    {
+    trailTime += 1.0 / 60.0;
+    double a = 0.004 * trailTime * 60.0;
+    double pos[3] = { 50.0 * std::cos(a), 50.0 * std::sin(a), 0.5 * a };
+    trail.addPoint(trailTime, pos);
+    };
+  for (int i = 0; i < 1000000; i++)
+    addTrailSample();
+  trail.update(trailTime);
+  r = runner.run("toolTrail/addPoint", [&]()
+    {
+    addTrailSample();
+    trail.update(trailTime);
+    });
+  if (r)
+    {
+    r->counters.push_back(std::make_pair("samples", (double)trail.getStatistics().numSamples));
+    r->counters.push_back(std::make_pair("trail_points", (double)trail.getStatistics().numPoints));
+    r->counters.push_back(std::make_pair("chunks", (double)trail.getStatistics().numChunks));
+    }
+
+  //
+  // segmented structures: small spheres on a grid, merged into one batch, and
+  // the cost of hiding one of them
+  //
+  std::vector< vtkSmartPointer<vtkPolyData> > structureMeshes;
+  int gridSize = (int)std::ceil(std::cbrt((double)opt.numStructures));
+  for (int i = 0; i < opt.numStructures; i++)
+    {
+    vtkNew<vtkSphereSource> s;
+    s->SetThetaResolution(32);
+    s->SetPhiResolution(32);
+    s->SetRadius(4.0);
+    s->SetCenter(10.0 * (i % gridSize), 10.0 * ((i / gridSize) % gridSize), 10.0 * (i / (gridSize * gridSize)));
+    s->Update();
+    structureMeshes.push_back(s->GetOutput());
+    }
+
+  meshBatcher structureBatches;
+  r = runner.run("structures/merge", [&]()
+    {
+    structureBatches.clear();
+    for (int i = 0; i < opt.numStructures; i++)
+      {
+      double color[3] = { 0.9, 0.5 + 0.5 * i / opt.numStructures, 0.4 };
+      structureBatches.addStructure("structure", structureMeshes[i], color);
+      }
+    structureBatches.update();
+    });
+  if (r)
+    {
+    meshBatcher::statistics s = structureBatches.getStatistics();
+    r->counters.push_back(std::make_pair("structures", (double)s.numStructures));
+    r->counters.push_back(std::make_pair("batches", (double)s.numBatches));
+    r->counters.push_back(std::make_pair("points", (double)s.numPoints));
+    }
+
+  int toggleCount = 0;
+  r = runner.run("structures/toggle", [&]()
+    {
+    int idx = toggleCount % opt.numStructures;
+    structureBatches.setVisibility(idx, !structureBatches.getVisibility(idx));
+    structureBatches.update();
+    toggleCount++;
+    });
+  if (r)
+    r->counters.push_back(std::make_pair("visible_cells", (double)structureBatches.getStatistics().numVisibleCells));
+  for (int i = 0; i < opt.numStructures; i++)
+    structureBatches.setVisibility(i, true);
+  structureBatches.update();
+
+  //
+  // NDI replies: parsing a reply with the transformations of all tools, binary
+  // (BX) against ASCII (TX)
+  //
+  ndiTransformReply ndiReply;
+  for (int i = 0; i < opt.numTools; i++)
+    {
+    ndiHandleTransform t;
+    t.handle = 0x0A + i;
+    t.status = enHandleValid;
+    t.q[0] = 0.5; t.q[1] = 0.5; t.q[2] = -0.5; t.q[3] = 0.5;
+    t.t[0] = 12.34 * i; t.t[1] = -56.78; t.t[2] = -1500.0;
+    t.error = 0.12;
+    t.portStatus = enPortOccupied | enPortInitialized | enPortEnabled;
+    t.frame = 1000;
+    ndiReply.handles.push_back(t);
+    }
+  std::vector<unsigned char> bxReply;
+  ndiEncodeBX(ndiReply, bxReply);
+  std::string txReply = ndiFormatReply(ndiEncodeTX(ndiReply));
+  txReply.pop_back(); // CR
+
+  ndiTransformReply parsed;
+  r = runner.run("ndi/parseBX", [&]()
+    {
+    for (int k = 0; k < 1000; k++)
+      ndiParseBX(bxReply.data(), bxReply.size(), parsed);
+    });
+  if (r)
+    {
+    r->counters.push_back(std::make_pair("replies_per_iteration", 1000.0));
+    r->counters.push_back(std::make_pair("bytes_per_reply", (double)bxReply.size()));
+    }
+
+  r = runner.run("ndi/parseTX", [&]()
+    {
+    std::string body;
+    for (int k = 0; k < 1000; k++)
+      if (ndiCheckReply(txReply, body))
+        ndiParseTX(body, parsed);
+    });
+  if (r)
+    {
+    r->counters.push_back(std::make_pair("replies_per_iteration", 1000.0));
+    r->counters.push_back(std::make_pair("bytes_per_reply", (double)txReply.size() + 1));
+    }
+
+#ifdef AIGS_WITH_NDI_EMULATOR
+  //
+  // NDI round trips through the emulator, which holds replies back by their
+  // time on the wire: TX at 115200 baud, as vtkNDITracker, then BX at the
+  // negotiated rate
+  //
+  ndiEmulator emulator;
+  emulator.setFrameRate(0.0);
+  ndiBinaryClient ndiClient;
+  if (emulator.start() && ndiClient.open(emulator.getDeviceName()) && ndiClient.initialize())
+    {
+    std::vector<unsigned char> srom(752, 0);
+    for (int i = 0; i < opt.numTools; i++)
+      ndiClient.addVirtualTool(srom);
+
+    ndiClient.negotiateBaudRate(115200);
+    ndiClient.startTracking();
+    r = runner.run("ndi/ptyTX", [&]()
+      {
+      ndiClient.getTransformsASCII(parsed);
+      });
+    if (r)
+      {
+      r->counters.push_back(std::make_pair("baud", (double)ndiClient.getStatistics().baudRate));
+      r->counters.push_back(std::make_pair("tools", (double)parsed.handles.size()));
+      }
+
+    ndiClient.stopTracking();
+    ndiClient.negotiateBaudRate();
+    ndiClient.startTracking();
+    r = runner.run("ndi/ptyBX", [&]()
+      {
+      ndiClient.getTransforms(parsed);
+      });
+    if (r)
+      {
+      r->counters.push_back(std::make_pair("baud", (double)ndiClient.getStatistics().baudRate));
+      r->counters.push_back(std::make_pair("tools", (double)parsed.handles.size()));
+      }
+    ndiClient.stopTracking();
+    }
+  else
+    {
+    std::cerr << "NDI emulator not available: " << ndiClient.getLastError() << std::endl;
+    }
+  ndiClient.close();
+  emulator.stop();
+#endif
+
+  //
+  // pivot calibration: accumulate every pose and solve
+  //
+  std::vector< std::vector<double> > poses = createPivotPoses(opt.numPivotPoses);
+  pivotCalibration pivot;
+  double tip[3], pivotPt[3], rms = 0.0;
+  r = runner.run("pivotCalibration/solve", [&]()
+    {
+    pivot.reset();
+    for (const std::vector<double> &m : poses)
+      pivot.addPose(m.data());
+    rms = pivot.solve(tip, pivotPt);
+    });
+  if (r)
+    {
+    r->counters.push_back(std::make_pair("poses", (double)opt.numPivotPoses));
+    r->counters.push_back(std::make_pair("rms_mm", rms));
+    }
+
+  //
+  // target registration error: Monte Carlo trials on 6 fiducials around the
+  // test mesh, then the per-vertex map
+  //
+  const double treSource[18] = { 50, 0, 0, -50, 0, 0, 0, 50, 0, 0, -50, 0, 0, 0, 50, 30, 30, -30 };
+  double treTarget[18];
+  for (int i = 0; i < 18; i++)
+    treTarget[i] = treSource[i] + 0.1 * std::sin(3.0 * i);
+  treEstimator tre;
+  r = runner.run("treEstimation/trials", [&]()
+    {
+    tre.estimate(treSource, treTarget, 6, 0.15, 20000);
+    });
+  if (r)
+    {
+    r->counters.push_back(std::make_pair("trials", 20000.0));
+    r->counters.push_back(std::make_pair("threads", (double)std::thread::hardware_concurrency()));
+    }
+
+  vtkNew<vtkFloatArray> treMap;
+  r = runner.run("treEstimation/map", [&]()
+    {
+    tre.computeTREMap(mesh, treMap);
+    });
+  if (r)
+    {
+    r->counters.push_back(std::make_pair("vertices", (double)mesh->GetNumberOfPoints()));
+    r->counters.push_back(std::make_pair("max_tre_mm", tre.getStatistics().maxTRE));
+    }
+
+  //
+  // laser plane: index the test mesh once, then slice it with a plane sweeping
+  // through the sphere at a new pose every iteration, as on each tracker sample
+  //
+  planeMeshSlicer slicer;
+  slicer.setMesh(mesh);
+  vtkNew<vtkPolyData> contour;
+  int sliceCount = 0;
+  r = runner.run("laserPlane/slice", [&]()
+    {
+    double angle = 0.05 * sliceCount;
+    double origin[3] = { 0.0, 0.0, 45.0 * std::sin(0.37 * sliceCount) };
+    double normal[3] = { std::sin(angle), 0.2, std::cos(angle) };
+    slicer.slice(origin, normal, contour);
+    sliceCount++;
+    });
+  if (r)
+    {
+    const planeMeshSlicer::statistics &s = slicer.getStatistics();
+    r->counters.push_back(std::make_pair("triangles", (double)s.numTriangles));
+    r->counters.push_back(std::make_pair("build_ms", s.buildMs));
+    r->counters.push_back(std::make_pair("triangles_tested", (double)s.trianglesTested));
+    r->counters.push_back(std::make_pair("segments", (double)s.segments));
+    }
+
+  //
+  // freehand ultrasound: compound an unpaced synthetic sweep, then build the output volume
+  //
+  usReconstructor usRecon;
+  vtkNew<vtkImageData> usVolume;
+  usReconstructor::statistics usStats;
+  r = runner.run("usReconstruction/insert", [&]()
+    {
+    std::unique_ptr<usSyntheticFrameSource> source(new usSyntheticFrameSource(640, 480, 30.0, opt.numUSFrames));
+    source->setPaced(false);
+    usRecon.start(std::move(source));
+    while (usRecon.isAcquiring())
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    usRecon.stop();
+    usStats = usRecon.getStatistics();
+    },
+    [&]()
+    {
+    usRecon.resetVolume();
+    });
+  if (r)
+    {
+    // unpaced: frames are queued as fast as they are synthesized
+    r->counters.push_back(std::make_pair("frames", (double)opt.numUSFrames));
+    r->counters.push_back(std::make_pair("fps", usStats.insertionFPS));
+    r->counters.push_back(std::make_pair("max_queue", (double)usStats.maxQueueLength));
+    }
+
+  r = runner.run("usReconstruction/output", [&]()
+    {
+    usRecon.updateOutput(usVolume);
+    });
+
+  //
+  // benchmarks that need an OpenGL context
+  //
+  if (opt.render)
+    {
+    vtkNew<vtkPolyDataMapper> mapper;
+    mapper->SetInputData(mesh);
+    vtkNew<vtkActor> actor;
+    actor->SetMapper(mapper);
+
+    vtkNew<vtkRenderer> ren;
+    ren->SetBackground(.1, .2, .4);
+    ren->AddActor(actor);
+
+    vtkNew<vtkLogoRepresentation> logo;
+    logo->SetImage(trackerDrawing->GetOutput());
+    logo->SetPosition(.45, 0);
+    logo->SetPosition2(.1, .1);
+    logo->GetImageProperty()->SetOpacity(.5);
+    logo->SetRenderer(ren);
+    ren->AddViewProp(logo);
+
+    vtkNew<vtkRenderWindow> renWin;
+    renWin->SetOffScreenRendering(1);
+    renWin->SetSize(800, 600);
+    renWin->AddRenderer(ren);
+    ren->ResetCamera();
+    renWin->Render();
+
+    vtkNew<vtkTextActor> statisticsText;
+    statisticsText->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
+    statisticsText->SetPosition(.56, .005);
+    statisticsText->GetTextProperty()->SetFontFamilyToCourier();
+    statisticsText->GetTextProperty()->SetFontSize(12);
+    ren->AddActor2D(statisticsText);
+
+    // the complete body of updateTrackerInfo(), with the simulated tracker
+    r = runner.run("updateTrackerInfo/frame", [&]()
+      {
+      trackerTick();
+      statisticsText->SetInput(tickText.c_str());
+      ren->ResetCameraClippingRange();
+      renWin->Render();
+      });
+    if (r)
+      r->counters.push_back(std::make_pair("tools", (double)opt.numTools));
+
+    long long nBytes = 0;
+    r = runner.run("screenShot/png", [&]()
+      {
+      nBytes = writeScreenShotPNG(renWin, nullptr);
+      });
+    if (r)
+      r->counters.push_back(std::make_pair("bytes", (double)nBytes));
+
+    // the same structures drawn as one batch, then as one actor each
+    vtkNew<vtkRenderer> batchedRen;
+    for (int b = 0; b < structureBatches.getNumberOfBatches(); b++)
+      {
+      vtkNew<vtkPolyDataMapper> m;
+      m->SetInputData(structureBatches.getBatch(b));
+      vtkNew<vtkActor> a;
+      a->SetMapper(m);
+      batchedRen->AddActor(a);
+      }
+
+    vtkNew<vtkRenderer> unbatchedRen;
+    for (int i = 0; i < opt.numStructures; i++)
+      {
+      vtkNew<vtkPolyDataMapper> m;
+      m->SetInputData(structureMeshes[i]);
+      vtkNew<vtkActor> a;
+      a->SetMapper(m);
+      a->GetProperty()->SetColor(0.9, 0.5 + 0.5 * i / opt.numStructures, 0.4);
+      unbatchedRen->AddActor(a);
+      }
+
+    renWin->RemoveRenderer(ren);
+    vtkRenderer *structureRenderers[] = { batchedRen, unbatchedRen };
+    const char *structureBenchmarks[] = { "structures/frame", "structures/frameUnbatched" };
+    for (int k = 0; k < 2; k++)
+      {
+      vtkRenderer *sRen = structureRenderers[k];
+      renWin->AddRenderer(sRen);
+      sRen->ResetCamera();
+      renWin->Render();
+      r = runner.run(structureBenchmarks[k], [&]()
+        {
+        sRen->GetActiveCamera()->Azimuth(1.0);
+        sRen->ResetCameraClippingRange();
+        renWin->Render();
+        });
+      if (r)
+        {
+        r->counters.push_back(std::make_pair("structures", (double)opt.numStructures));
+        r->counters.push_back(std::make_pair("actors", (double)sRen->GetActors()->GetNumberOfItems()));
+        }
+      renWin->RemoveRenderer(sRen);
+      }
+
+    // the trail drawn while it grows: only the head chunk changes between frames
+    vtkNew<vtkRenderer> trailRen;
+    for (int i = 0; i < trail.getNumberOfSlots(); i++)
+      {
+      vtkNew<vtkPolyDataMapper> m;
+      m->SetInputData(trail.getSlot(i));
+      vtkNew<vtkActor> a;
+      a->SetMapper(m);
+      a->GetProperty()->LightingOff();
+      trailRen->AddActor(a);
+      }
+    renWin->AddRenderer(trailRen);
+    trailRen->ResetCamera();
+    renWin->Render();
+    r = runner.run("toolTrail/frame", [&]()
+      {
+      addTrailSample();
+      trail.update(trailTime);
+      trailRen->ResetCameraClippingRange();
+      renWin->Render();
+      });
+    if (r)
+      {
+      r->counters.push_back(std::make_pair("trail_points", (double)trail.getStatistics().numPoints));
+      r->counters.push_back(std::make_pair("modified_chunks", (double)trail.getStatistics().modifiedChunks));
+      }
+    renWin->RemoveRenderer(trailRen);
+    }
+
+  if (opt.outputFile.empty())
+    {
+    runner.writeJSON(std::cout, vtkVersion::GetVTKVersion());
+    }
+  else
+    {
+    std::ofstream os(opt.outputFile.c_str());
+    if (!os)
+      {
+      std::cerr << "Cannot write " << opt.outputFile << std::endl;
+      return EXIT_FAILURE;
+      }
+    runner.writeJSON(os, vtkVersion::GetVTKVersion());
+    }
+
+  return EXIT_SUCCESS;
+}
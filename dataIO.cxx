@@ -0,0 +1,174 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: dataIO.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "dataIO.h"
+#include "traceRecorder.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageExtractComponents.h>
+#include <vtkMetaImageReader.h>
+#include <vtkNew.h>
+#include <vtkNrrdReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPNGWriter.h>
+#include <vtkPolyDataReader.h>
+#include <vtkRenderWindow.h>
+#include <vtkSTLReader.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkWindowToImageFilter.h>
+#include <vtkXMLPolyDataReader.h>
+
+// C++ includes
+#include <algorithm>
+#include <cctype>
+
+
+std::string fileExtension(const std::string &fname)
+{
+  std::string::size_type dot = fname.find_last_of('.');
+  std::string::size_type slash = fname.find_last_of("/\\");
+
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    return std::string();
+
+  std::string ext = fname.substr(dot + 1);
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+    [](unsigned char c) { return (char)std::tolower(c); });
+  return ext;
+}
+
+
+vtkSmartPointer<vtkPolyData> readMeshFile(const std::string &fname)
+{
+  AIGS_TRACE_SCOPE("readMeshFile");
+  std::string ext = fileExtension(fname);
+  vtkPolyData *data = nullptr;
+
+  // parse the file extension and use the appropriate reader
+  if (ext == "vtk")
+    {
+    data = readAnPolyData<vtkPolyDataReader>(fname.c_str());
+    }
+  else if (ext == "stl" || ext == "stlb")
+    {
+    data = readAnPolyData<vtkSTLReader>(fname.c_str());
+    }
+  else if (ext == "ply")
+    {
+    data = readAnPolyData<vtkPLYReader>(fname.c_str());
+    }
+  else if (ext == "obj")
+    {
+    data = readAnPolyData<vtkOBJReader>(fname.c_str());
+    }
+  else if (ext == "vtp")
+    {
+    data = readAnPolyData<vtkXMLPolyDataReader>(fname.c_str());
+    }
+
+  // take over the reference handed out by readAnPolyData
+  return vtkSmartPointer<vtkPolyData>::Take(data);
+}
+
+
+bool readVolumeFile(const std::string &fname, vtkImageData *imageData)
+{
+  AIGS_TRACE_SCOPE("readVolumeFile");
+  std::string ext = fileExtension(fname);
+
+  if (ext == "nrrd")
+    {
+    // .nrrd file type. But it looks like if the compressed format isn't supported.
+    vtkNew<vtkNrrdReader> reader;
+    reader->SetFileName(fname.c_str());
+    reader->Update();
+    imageData->ShallowCopy(reader->GetOutput());
+    }
+  else if (ext == "mhd")
+    {
+    // standard metafile
+    vtkNew<vtkMetaImageReader> reader;
+    reader->SetFileName(fname.c_str());
+    reader->Update();
+    imageData->ShallowCopy(reader->GetOutput());
+    }
+  else
+    {
+    return false;
+    }
+
+  return true;
+}
+
+
+long long writeScreenShotPNG(vtkRenderWindow *renWin, const char *fname)
+{
+  AIGS_TRACE_SCOPE("writeScreenShotPNG");
+  vtkNew<vtkWindowToImageFilter> w2i;
+  w2i->SetInput(renWin);
+  w2i->ReadFrontBufferOff();
+  w2i->SetInputBufferTypeToRGBA();
+
+  vtkNew<vtkImageExtractComponents> iec;
+  iec->SetInputConnection(w2i->GetOutputPort());
+  iec->SetComponents(0, 1, 2);
+
+  vtkNew<vtkPNGWriter> writer;
+  writer->SetInputConnection(iec->GetOutputPort());
+
+  if (fname)
+    {
+    writer->SetFileName(fname);
+    writer->Write();
+    return 0;
+    }
+
+  writer->WriteToMemoryOn();
+  writer->Write();
+  return (long long)writer->GetResult()->GetNumberOfTuples();
+}
@@ -0,0 +1,98 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: dataIO.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __DATAIO_H__
+#define __DATAIO_H__
+
+#pragma once
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+// C++ includes
+#include <string>
+
+// VTK forward declaration
+class vtkImageData;
+class vtkRenderWindow;
+
+/*!
+* Read a polydata using the reader type PReader.
+*
+* The returned polydata carries an extra reference that is owned by the caller.
+*/
+template< class PReader > vtkPolyData *readAnPolyData(const char *fname) {
+  vtkSmartPointer< PReader > reader =
+    vtkSmartPointer< PReader >::New();
+  reader->SetFileName(fname);
+  reader->Update();
+  reader->GetOutput()->Register(reader);
+  return(vtkPolyData::SafeDownCast(reader->GetOutput()));
+  }
+
+//! lower-case file extension without the leading dot, e.g. "stl"
+std::string fileExtension(const std::string &fname);
+
+/*!
+* Read a mesh (.vtk, .stl, .stlb, .ply, .obj, .vtp) choosing the reader from the
+* file extension. Returns nullptr if the file type is not supported.
+*/
+vtkSmartPointer<vtkPolyData> readMeshFile(const std::string &fname);
+
+/*!
+* Read a volume (.nrrd, .mhd) into imageData, choosing the reader from the file
+* extension. Returns false if the file type is not supported.
+*/
+bool readVolumeFile(const std::string &fname, vtkImageData *imageData);
+
+/*!
+* Grab the back buffer of renWin and encode it as an RGB PNG.
+*
+* If fname is nullptr the PNG is encoded in memory only (used for benchmarking).
+* Returns the size of the encoded image in bytes when written to memory, 0 otherwise.
+*/
+long long writeScreenShotPNG(vtkRenderWindow *renWin, const char *fname);
+
+#endif // of __DATAIO_H__
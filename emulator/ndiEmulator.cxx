@@ -0,0 +1,378 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiEmulator.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "ndiEmulator.h"
+
+// C++ includes
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+const double pi = 3.14159265358979323846;
+
+// ERROR codes of the API used here
+const char *invalidCommand = "ERROR01";
+const char *invalidParameter = "ERROR04";
+const char *invalidState = "ERROR0C";
+} // namespace
+
+
+ndiEmulator::ndiEmulator()
+{
+  maxBaudRate = 921600;
+  simulateLineRate = true;
+  frameRate = 60.0;
+  masterFd = slaveFd = -1;
+  running = false;
+  this->reset();
+}
+
+
+ndiEmulator::~ndiEmulator()
+{
+  this->stop();
+}
+
+
+void ndiEmulator::reset()
+{
+  baudRate = 9600;
+  tracking = false;
+  handles.clear();
+  frame = 0;
+}
+
+
+bool ndiEmulator::start()
+{
+  this->stop();
+#ifdef _WIN32
+  return false;
+#else
+  masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0 || !ptsname(masterFd))
+    {
+    this->stop();
+    return false;
+    }
+  deviceName = ptsname(masterFd);
+
+  // keep the slave open: the master then never sees a hang-up between clients
+  slaveFd = open(deviceName.c_str(), O_RDWR | O_NOCTTY);
+  termios tio;
+  if (slaveFd < 0 || tcgetattr(slaveFd, &tio) != 0)
+    {
+    this->stop();
+    return false;
+    }
+  cfmakeraw(&tio);
+  tcsetattr(slaveFd, TCSANOW, &tio);
+
+  this->reset();
+  stats = statistics();
+  running = true;
+  device = std::thread(&ndiEmulator::run, this);
+  return true;
+#endif
+}
+
+
+void ndiEmulator::stop()
+{
+  running = false;
+  if (device.joinable())
+    device.join();
+#ifndef _WIN32
+  if (slaveFd >= 0)
+    close(slaveFd);
+  if (masterFd >= 0)
+    close(masterFd);
+#endif
+  masterFd = slaveFd = -1;
+  deviceName.clear();
+}
+
+
+ndiEmulator::statistics ndiEmulator::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(statsMutex);
+  return stats;
+}
+
+
+void ndiEmulator::run()
+{
+#ifndef _WIN32
+  std::string line;
+  char chunk[4096];
+  while (running)
+    {
+    pollfd p = { masterFd, POLLIN, 0 };
+    if (poll(&p, 1, 50) <= 0)
+      continue;
+    ssize_t n = read(masterFd, chunk, sizeof(chunk));
+    if (n <= 0)
+      continue;
+
+    for (ssize_t i = 0; i < n; i++)
+      {
+      if (chunk[i] != '\r')
+        {
+        line += chunk[i];
+        continue;
+        }
+
+      std::string name, params;
+      if (ndiParseCommand(line, name, params))
+        this->reply(name, params);
+      else
+        this->send(ndiFormatReply("ERROR03")); // CRC error
+      line.clear();
+      }
+    }
+#endif
+}
+
+
+void ndiEmulator::send(const std::string &data)
+{
+#ifndef _WIN32
+  auto t0 = std::chrono::steady_clock::now();
+  size_t done = 0;
+  while (done < data.size() && running)
+    {
+    ssize_t n = write(masterFd, data.data() + done, data.size() - done);
+    if (n > 0)
+      done += n;
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+  // 10 bits per byte on an 8N1 line
+  if (simulateLineRate)
+    std::this_thread::sleep_until(t0 + std::chrono::microseconds((long long)(1e7 * data.size() / baudRate)));
+
+  std::lock_guard<std::mutex> lock(statsMutex);
+  stats.bytesWritten += done;
+  stats.baudRate = baudRate;
+#else
+  (void)data;
+#endif
+}
+
+
+void ndiEmulator::reply(const std::string &name, const std::string &params)
+{
+  {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  stats.commands++;
+  }
+
+  unsigned int handle = 0;
+  bool hasHandle = params.size() >= 2 && std::sscanf(params.c_str(), "%2X", &handle) == 1;
+  auto h = handles.find((int)handle);
+
+  if (name == "INIT")
+    {
+    tracking = false;
+    handles.clear();
+    this->send(ndiFormatReply("OKAY"));
+    }
+  else if (name == "COMM")
+    {
+    int baud = params.empty() ? 0 : ndiBaudFromCode(params[0]);
+    if (baud == 0 || baud > maxBaudRate)
+      {
+      this->send(ndiFormatReply(invalidParameter));
+      return;
+      }
+    // the reply still goes out at the old rate
+    this->send(ndiFormatReply("OKAY"));
+    baudRate = baud;
+    }
+  else if (name == "VER")
+    {
+    this->send(ndiFormatReply("Basic_QtVTK_AIGS NDI emulator\nFreeze Tag: 000.000\n"));
+    }
+  else if (name == "BEEP")
+    {
+    this->send(ndiFormatReply("1"));
+    }
+  else if (name == "PHRQ")
+    {
+    // handles are given out from 0x0A, as by the Polaris for wireless tools
+    int next = 0x0A;
+    while (handles.count(next))
+      next++;
+    handles[next] = portHandle();
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%02X", next);
+    this->send(ndiFormatReply(buf));
+    }
+  else if (name == "PVWR")
+    {
+    unsigned int address;
+    if (!hasHandle || h == handles.end() || params.size() != 2 + 4 + 128 ||
+      std::sscanf(params.c_str() + 2, "%4X", &address) != 1 || address % 64 != 0)
+      {
+      this->send(ndiFormatReply(invalidParameter));
+      return;
+      }
+    std::vector<unsigned char> &srom = h->second.srom;
+    if (srom.size() < address + 64)
+      srom.resize(address + 64);
+    for (int k = 0; k < 64; k++)
+      srom[address + k] = (unsigned char)std::strtoul(params.substr(6 + 2 * k, 2).c_str(), nullptr, 16);
+    this->send(ndiFormatReply("OKAY"));
+    }
+  else if (name == "PINIT" || name == "PENA" || name == "PDIS" || name == "PHF")
+    {
+    if (!hasHandle || h == handles.end() || (name == "PENA" && !h->second.initialized))
+      {
+      this->send(ndiFormatReply(name == "PENA" && hasHandle && h != handles.end() ? invalidState : invalidParameter));
+      return;
+      }
+    if (name == "PINIT")
+      h->second.initialized = true;
+    else if (name == "PENA")
+      h->second.enabled = true;
+    else if (name == "PDIS")
+      h->second.enabled = false;
+    else
+      handles.erase(h);
+    this->send(ndiFormatReply("OKAY"));
+    }
+  else if (name == "TSTART")
+    {
+    tracking = true;
+    frame = 0;
+    trackingStart = std::chrono::steady_clock::now();
+    this->send(ndiFormatReply("OKAY"));
+    }
+  else if (name == "TSTOP")
+    {
+    tracking = false;
+    this->send(ndiFormatReply("OKAY"));
+    }
+  else if (name == "TX" || name == "BX")
+    {
+    if (!tracking)
+      {
+      this->send(ndiFormatReply(invalidState));
+      return;
+      }
+
+    ndiTransformReply transforms;
+    this->fillTransforms(transforms);
+    if (name == "TX")
+      {
+      this->send(ndiFormatReply(ndiEncodeTX(transforms)));
+      }
+    else
+      {
+      binary.clear();
+      ndiEncodeBX(transforms, binary);
+      this->send(std::string(binary.begin(), binary.end()));
+      }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.transformReplies++;
+    }
+  else
+    {
+    this->send(ndiFormatReply(invalidCommand));
+    }
+}
+
+
+void ndiEmulator::fillTransforms(ndiTransformReply &transforms)
+{
+  double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - trackingStart).count();
+  double rate = frameRate;
+  if (rate > 0.0)
+    {
+    frame = (unsigned int)(t * rate);
+    t = frame / rate;
+    }
+  else
+    {
+    frame++;
+    }
+
+  transforms.systemStatus = 0;
+  for (const auto &h : handles)
+    {
+    if (!h.second.enabled)
+      continue;
+
+    ndiHandleTransform tr;
+    tr.handle = h.first;
+    tr.status = enHandleValid;
+    tr.portStatus = enPortOccupied | enPortInitialized | enPortEnabled;
+    tr.frame = frame;
+
+    // a circle in the xy plane per tool, turning about z at 0.5 Hz
+    double angle = 2.0 * pi * 0.5 * t + h.first;
+    tr.q[0] = std::cos(0.5 * angle);
+    tr.q[1] = tr.q[2] = 0.0;
+    tr.q[3] = std::sin(0.5 * angle);
+    tr.t[0] = 80.0 * std::cos(angle) + 30.0 * (h.first - 0x0A);
+    tr.t[1] = 80.0 * std::sin(angle);
+    tr.t[2] = -1500.0;
+    tr.error = 0.12;
+    transforms.handles.push_back(tr);
+    }
+}
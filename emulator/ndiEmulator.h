@@ -0,0 +1,142 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiEmulator.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __NDIEMULATOR_H__
+#define __NDIEMULATOR_H__
+
+#pragma once
+
+// local includes
+#include "ndiProtocol.h"
+
+// C++ includes
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+* Emulated NDI tracking system behind a pseudo-terminal, so that the serial
+* acquisition can be tested and benchmarked without hardware. Clients open
+* getDeviceName() as they would open /dev/ttyUSB0.
+*
+* Implements INIT, COMM, VER, BEEP, PHRQ, PVWR, PINIT, PENA, PDIS, PHF, TSTART,
+* TSTOP, TX and BX (option 0x0001). Every enabled tool moves on its own circle.
+* By default each reply is held back for as long as it would take on a serial
+* line at the current baud rate, so the reply size matters as it does on a
+* real line.
+*/
+class ndiEmulator
+{
+public:
+  struct statistics
+    {
+    int       baudRate = 9600;
+    long long commands = 0;
+    long long transformReplies = 0;
+    long long bytesWritten = 0;
+    };
+
+  ndiEmulator();
+  ~ndiEmulator();
+
+  //! highest rate COMM accepts (default 921600)
+  void setMaximumBaudRate(int baud) { maxBaudRate = baud; }
+
+  //! hold replies back by their transmission time (default on)
+  void setSimulateLineRate(bool on) { simulateLineRate = on; }
+
+  //! rate of new frames in Hz; 0 makes every TX/BX a new frame (default 60)
+  void setFrameRate(double hz) { frameRate = hz; }
+
+  //! create the pseudo-terminal and start answering
+  bool start();
+  void stop();
+
+  //! path of the pseudo-terminal to open, valid after start()
+  const std::string &getDeviceName() const { return deviceName; }
+
+  statistics getStatistics() const;
+
+private:
+  struct portHandle
+    {
+    std::vector<unsigned char>  srom;
+    bool                        initialized = false;
+    bool                        enabled = false;
+    };
+
+  void run();
+  void reply(const std::string &name, const std::string &params);
+  void send(const std::string &data);
+  void fillTransforms(ndiTransformReply &transforms);
+  void reset();
+
+  // settings, read by the device thread
+  std::atomic<int>      maxBaudRate;
+  std::atomic<bool>     simulateLineRate;
+  std::atomic<double>   frameRate;
+
+  int                   masterFd, slaveFd;
+  std::string           deviceName;
+  std::thread           device;
+  std::atomic<bool>     running;
+
+  // device state, device thread only
+  int                           baudRate;
+  bool                          tracking;
+  std::map<int, portHandle>     handles;
+  unsigned int                  frame;
+  std::chrono::steady_clock::time_point trackingStart;
+  std::vector<unsigned char>    binary;
+
+  mutable std::mutex    statsMutex;
+  statistics            stats;
+};
+
+#endif // of __NDIEMULATOR_H__
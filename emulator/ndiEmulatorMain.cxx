@@ -0,0 +1,113 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiEmulatorMain.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "ndiEmulator.h"
+
+// C++ includes
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+namespace
+{
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int)
+{
+  stopRequested = 1;
+}
+
+
+void printUsage(const char *prog)
+{
+  std::cerr << "Usage: " << prog << " [options]\n"
+    << "  --max-baud <n>      highest rate accepted by COMM (default: 921600)\n"
+    << "  --frame-rate <hz>   new frames per second, 0 for a new frame per request (default: 60)\n"
+    << "  --no-line-rate      reply as fast as possible instead of at the baud rate\n";
+}
+} // namespace
+
+
+int main(int argc, char *argv[])
+{
+  ndiEmulator emulator;
+  for (int i = 1; i < argc; i++)
+    {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if (arg == "--max-baud" && hasValue)
+      emulator.setMaximumBaudRate(std::atoi(argv[++i]));
+    else if (arg == "--frame-rate" && hasValue)
+      emulator.setFrameRate(std::atof(argv[++i]));
+    else if (arg == "--no-line-rate")
+      emulator.setSimulateLineRate(false);
+    else
+      {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+      }
+    }
+
+  if (!emulator.start())
+    {
+    std::cerr << "Cannot create a pseudo-terminal" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << emulator.getDeviceName() << std::endl;
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+  while (!stopRequested)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  ndiEmulator::statistics stats = emulator.getStatistics();
+  emulator.stop();
+  std::cerr << stats.commands << " commands, " << stats.transformReplies << " transformation replies, "
+    << stats.bytesWritten << " bytes written, last rate " << stats.baudRate << " baud" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: isoSurfaceExtractor.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "isoSurfaceExtractor.h"
+#include "traceRecorder.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkFlyingEdges3D.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+
+
+isoSurfaceExtractor::isoSurfaceExtractor(int size)
+  : inputGeneration(0), cacheSize(std::max(1, size)), requestedThreshold(0.0),
+  resultThreshold(0.0), hasRequest(false), hasResult(false), stopping(false)
+{
+  worker = std::thread(&isoSurfaceExtractor::workerLoop, this);
+}
+
+
+isoSurfaceExtractor::~isoSurfaceExtractor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  requestChanged.notify_one();
+  worker.join();
+}
+
+
+void isoSurfaceExtractor::setInput(vtkImageData *image)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  input = image;
+  inputGeneration++;
+  cache.clear();
+  hasResult = false;
+  result = nullptr;
+}
+
+
+void isoSurfaceExtractor::setSurfaceReadyCallback(std::function<void()> callback)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  surfaceReady = callback;
+}
+
+
+void isoSurfaceExtractor::requestSurface(double threshold)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    requestedThreshold = threshold;
+    hasRequest = true;
+  }
+  requestChanged.notify_one();
+}
+
+
+bool isoSurfaceExtractor::takeSurface(double &threshold, vtkSmartPointer<vtkPolyData> &surface)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!hasResult)
+    return false;
+
+  threshold = resultThreshold;
+  surface = result;
+  hasResult = false;
+  result = nullptr;
+  return true;
+}
+
+
+isoSurfaceExtractor::statistics isoSurfaceExtractor::getStatistics()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+
+vtkSmartPointer<vtkPolyData> isoSurfaceExtractor::extract(double threshold)
+{
+  unsigned long generation;
+  return this->extract(threshold, generation);
+}
+
+
+vtkSmartPointer<vtkPolyData> isoSurfaceExtractor::extract(double threshold, unsigned long &generation)
+{
+  AIGS_TRACE_SCOPE("isoSurfaceExtractor::extract");
+  vtkSmartPointer<vtkImageData> image;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    generation = inputGeneration;
+    for (auto it = cache.begin(); it != cache.end(); ++it)
+      {
+      if (it->first == threshold)
+        {
+        cache.splice(cache.begin(), cache, it);
+        stats.cacheHits++;
+        stats.extractMs = 0.0;
+        stats.numTriangles = it->second->GetNumberOfPolys();
+        return it->second;
+        }
+      }
+    image = input;
+  }
+
+  if (!image)
+    return nullptr;
+
+  auto t0 = std::chrono::steady_clock::now();
+  vtkSmartPointer<vtkPolyData> surface = this->contour(image, threshold);
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  stats.cacheMisses++;
+  stats.extractMs = ms;
+  stats.numTriangles = surface ? surface->GetNumberOfPolys() : 0;
+  if (surface && generation == inputGeneration)
+    {
+    cache.emplace_front(threshold, surface);
+    if ((int)cache.size() > cacheSize)
+      cache.pop_back();
+    }
+  return surface;
+}
+
+
+vtkSmartPointer<vtkPolyData> isoSurfaceExtractor::contour(vtkImageData *image, double threshold)
+{
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  if (!scalars)
+    return nullptr;
+
+  // contour a zero-copy view of the volume, so that extractions on the GUI and
+  // the worker thread never share pipeline information through image
+  vtkSmartPointer<vtkDataArray> view = vtkSmartPointer<vtkDataArray>::Take(scalars->NewInstance());
+  view->SetNumberOfComponents(scalars->GetNumberOfComponents());
+  view->SetVoidArray(scalars->GetVoidPointer(0), scalars->GetNumberOfValues(), 1);
+
+  vtkNew<vtkImageData> volume;
+  volume->SetOrigin(image->GetOrigin());
+  volume->SetSpacing(image->GetSpacing());
+  volume->SetExtent(image->GetExtent());
+  volume->GetPointData()->SetScalars(view);
+
+  vtkNew<vtkFlyingEdges3D> flyingEdges;
+  flyingEdges->SetInputData(volume);
+  flyingEdges->SetValue(0, threshold);
+  flyingEdges->SetArrayComponent(0);
+  flyingEdges->ComputeNormalsOn();
+  flyingEdges->ComputeScalarsOff();
+  flyingEdges->Update();
+
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  surface->ShallowCopy(flyingEdges->GetOutput());
+  return surface;
+}
+
+
+void isoSurfaceExtractor::workerLoop()
+{
+  traceRecorder::setThreadName("iso-surface worker");
+  for (;;)
+    {
+    double threshold;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      requestChanged.wait(lock, [this] { return hasRequest || stopping; });
+      if (stopping)
+        return;
+      threshold = requestedThreshold;
+      hasRequest = false;
+    }
+
+    unsigned long generation;
+    vtkSmartPointer<vtkPolyData> surface = this->extract(threshold, generation);
+
+    std::function<void()> callback;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!surface || generation != inputGeneration)
+        continue; // the volume changed meanwhile
+      result = surface;
+      resultThreshold = threshold;
+      hasResult = true;
+      callback = surfaceReady;
+    }
+    if (callback)
+      callback();
+    }
+}
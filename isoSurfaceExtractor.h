@@ -0,0 +1,133 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: isoSurfaceExtractor.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __ISOSURFACEEXTRACTOR_H__
+#define __ISOSURFACEEXTRACTOR_H__
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+
+// C++ includes
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// VTK forward declaration
+class vtkImageData;
+class vtkPolyData;
+
+/*!
+* Iso-surface extraction from an in-memory volume, for interactive thresholds.
+*
+* The whole volume is contoured by one vtkFlyingEdges3D, through a zero-copy
+* view of its scalars. Flying edges is itself parallel over the x rows (with
+* any vtkSMPTools backend other than Sequential), so the surface comes out in
+* one piece, without seams or duplicated vertices.
+*
+* The most recent surfaces are cached by threshold, so moving a slider back
+* and forth does not contour again. requestSurface() runs the extraction on a
+* worker thread: a request replaces one that has not started yet, and the
+* callback announces each finished surface, which is picked up with
+* takeSurface().
+*/
+class isoSurfaceExtractor
+{
+public:
+  struct statistics
+    {
+    double    extractMs = 0.0;   // last extraction, 0 for a cache hit
+    long long numTriangles = 0;  // of the last surface returned
+    int       cacheHits = 0, cacheMisses = 0;
+    };
+
+  explicit isoSurfaceExtractor(int cacheSize = 8);
+  ~isoSurfaceExtractor();
+
+  /*!
+  * The volume to contour (single component, or component 0 is used). It must
+  * not be modified while it is set. Clears the cache.
+  */
+  void setInput(vtkImageData *image);
+
+  //! extract on the calling thread (through the cache). The surface must not be modified.
+  vtkSmartPointer<vtkPolyData> extract(double threshold);
+
+  //! extract on the worker thread
+  void requestSurface(double threshold);
+
+  //! called on the worker thread when a requested surface is ready
+  void setSurfaceReadyCallback(std::function<void()> callback);
+
+  //! the latest finished request, if there is one not taken yet
+  bool takeSurface(double &threshold, vtkSmartPointer<vtkPolyData> &surface);
+
+  statistics getStatistics();
+
+private:
+  vtkSmartPointer<vtkPolyData> extract(double threshold, unsigned long &generation);
+  vtkSmartPointer<vtkPolyData> contour(vtkImageData *image, double threshold);
+  void workerLoop();
+
+  std::thread                   worker;         // runs the requests
+  std::mutex                    mutex;
+  std::condition_variable       requestChanged;
+  std::function<void()>         surfaceReady;
+
+  vtkSmartPointer<vtkImageData> input;
+  unsigned long                 inputGeneration;
+  std::list< std::pair<double, vtkSmartPointer<vtkPolyData> > > cache; // most recent first
+  int                           cacheSize;
+
+  double                        requestedThreshold, resultThreshold;
+  bool                          hasRequest, hasResult, stopping;
+  vtkSmartPointer<vtkPolyData>  result;
+  statistics                    stats;
+};
+
+#endif // of __ISOSURFACEEXTRACTOR_H__
@@ -0,0 +1,165 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: landmarkRegistration.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "landmarkRegistration.h"
+
+// VTK includes
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPoints.h>
+
+// C++ includes
+#include <cmath>
+#include <vector>
+
+
+double landmarkRegistration(const double *source, const double *target, int n, double M[16])
+{
+  if (n < 3)
+    return -1.0;
+
+  // centroids
+  double sc[3] = { 0.0, 0.0, 0.0 }, tc[3] = { 0.0, 0.0, 0.0 };
+  for (int i = 0; i < n; i++)
+    {
+    for (int j = 0; j < 3; j++)
+      {
+      sc[j] += source[3 * i + j];
+      tc[j] += target[3 * i + j];
+      }
+    }
+  for (int j = 0; j < 3; j++)
+    {
+    sc[j] /= n;
+    tc[j] /= n;
+    }
+
+  // cross-covariance of the centred point sets
+  double S[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+  for (int i = 0; i < n; i++)
+    {
+    double a[3], b[3];
+    for (int j = 0; j < 3; j++)
+      {
+      a[j] = source[3 * i + j] - sc[j];
+      b[j] = target[3 * i + j] - tc[j];
+      }
+    for (int r = 0; r < 3; r++)
+      for (int c = 0; c < 3; c++)
+        S[r][c] += a[r] * b[c];
+    }
+
+  // Horn's symmetric 4x4 matrix; its dominant eigenvector is the rotation quaternion
+  double N0[4], N1[4], N2[4], N3[4], *N[4] = { N0, N1, N2, N3 };
+  N0[0] = S[0][0] + S[1][1] + S[2][2];
+  N1[1] = S[0][0] - S[1][1] - S[2][2];
+  N2[2] = -S[0][0] + S[1][1] - S[2][2];
+  N3[3] = -S[0][0] - S[1][1] + S[2][2];
+  N0[1] = N1[0] = S[1][2] - S[2][1];
+  N0[2] = N2[0] = S[2][0] - S[0][2];
+  N0[3] = N3[0] = S[0][1] - S[1][0];
+  N1[2] = N2[1] = S[0][1] + S[1][0];
+  N1[3] = N3[1] = S[2][0] + S[0][2];
+  N2[3] = N3[2] = S[1][2] + S[2][1];
+
+  double eigenvalues[4];
+  double V0[4], V1[4], V2[4], V3[4], *V[4] = { V0, V1, V2, V3 };
+  vtkMath::JacobiN(N, 4, eigenvalues, V);
+
+  // eigenvectors are sorted by decreasing eigenvalue and stored as columns
+  double q[4] = { V[0][0], V[1][0], V[2][0], V[3][0] };
+  double R[3][3];
+  vtkMath::QuaternionToMatrix3x3(q, R);
+
+  for (int r = 0; r < 3; r++)
+    {
+    for (int c = 0; c < 3; c++)
+      M[4 * r + c] = R[r][c];
+    M[4 * r + 3] = tc[r] - (R[r][0] * sc[0] + R[r][1] * sc[1] + R[r][2] * sc[2]);
+    }
+  M[12] = M[13] = M[14] = 0.0;
+  M[15] = 1.0;
+
+  // fiducial registration error
+  double sum = 0.0;
+  for (int i = 0; i < n; i++)
+    {
+    const double *p = source + 3 * i;
+    const double *t = target + 3 * i;
+    for (int r = 0; r < 3; r++)
+      {
+      double d = M[4 * r] * p[0] + M[4 * r + 1] * p[1] + M[4 * r + 2] * p[2] + M[4 * r + 3] - t[r];
+      sum += d * d;
+      }
+    }
+
+  return std::sqrt(sum / n);
+}
+
+
+double landmarkRegistration(vtkPoints *source, vtkPoints *target, vtkMatrix4x4 *M)
+{
+  if (!source || !target)
+    return -1.0;
+
+  int n = (int)source->GetNumberOfPoints();
+  if (n != (int)target->GetNumberOfPoints())
+    return -1.0;
+
+  std::vector<double> s(3 * n), t(3 * n);
+  for (int i = 0; i < n; i++)
+    {
+    source->GetPoint(i, &s[3 * i]);
+    target->GetPoint(i, &t[3 * i]);
+    }
+
+  double m[16];
+  double fre = landmarkRegistration(s.data(), t.data(), n, m);
+  if (fre >= 0.0)
+    M->DeepCopy(m);
+
+  return fre;
+}
@@ -0,0 +1,72 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: landmarkRegistration.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __LANDMARKREGISTRATION_H__
+#define __LANDMARKREGISTRATION_H__
+
+#pragma once
+
+// VTK forward declaration
+class vtkMatrix4x4;
+class vtkPoints;
+
+/*!
+* Rigid-body point-based registration (Horn's closed-form quaternion solution,
+* as in vtkLandmarkTransform with SetModeToRigidBody).
+*
+* source and target hold n corresponding points as interleaved xyz. On return,
+* M is the row-major 4x4 matrix mapping source onto target.
+*
+* Returns the fiducial registration error (RMS distance in the units of the
+* input), or -1 if n < 3.
+*
+* The function does not allocate and is safe to call from several threads.
+*/
+double landmarkRegistration(const double *source, const double *target, int n, double M[16]);
+
+//! vtkPoints convenience version. Returns -1 if the point counts differ or are < 3.
+double landmarkRegistration(vtkPoints *source, vtkPoints *target, vtkMatrix4x4 *M);
+
+#endif // of __LANDMARKREGISTRATION_H__
@@ -43,7 +43,14 @@ POSSIBILITY OF SUCH DAMAGES.
 =========================================================================*/
 
 // local includes
+#include "dataIO.h"
+#include "landmarkRegistration.h"
 #include "mainWindows.h"
+#include "renderThread.h"
+#include "traceObserver.h"
+#include "traceRecorder.h"
+#include "vtkNDIBinaryTracker.h"
+#include "trackerStatusDrawing.h"
 
 // VTK includes
 #include <vtkActor.h>
@@ -56,23 +63,20 @@ POSSIBILITY OF SUCH DAMAGES.
 #include <vtkGenericOpenGLRenderWindow.h>
 #include <vtkImageCanvasSource2D.h>
 #include <vtkImageData.h>
-#include <vtkImageExtractComponents.h>
 #include <vtkLineSource.h>
 #include <vtkLogoRepresentation.h>
+#include <vtkFloatArray.h>
 #include <vtkLogoWidget.h>
+#include <vtkLookupTable.h>
+#include <vtkMath.h>
 #include <vtkMatrix4x4.h>
-#include <vtkMetaImageReader.h>
 #include <vtkNamedColors.h>
 #include <vtkNew.h>
-#include <vtkNrrdReader.h>
-#include <vtkOBJReader.h>
-#include <vtkPLYReader.h>
-#include <vtkPNGWriter.h>
 #include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
-#include <vtkPolyDataReader.h>
 #include <vtkProperty.h>
 #include <vtkProperty2D.h>
 #include <vtkRenderer.h>
@@ -82,14 +86,14 @@ POSSIBILITY OF SUCH DAMAGES.
 #include <vtkSimplePointsWriter.h>
 #include <vtkSmartPointer.h>
 #include <vtkSmartVolumeMapper.h>
-#include <vtkSTLReader.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
 #include <vtkTexturedButtonRepresentation2D.h>
+#include <vtkTimerLog.h>
 #include <vtkTransform.h>
 #include <vtkTubeFilter.h>
 #include <vtkVolume.h>
 #include <vtkVolumeProperty.h>
-#include <vtkWindowToImageFilter.h>
-#include <vtkXMLPolyDataReader.h>
 
 
 
@@ -102,51 +106,80 @@ POSSIBILITY OF SUCH DAMAGES.
 #include <QDebug>
 #include <QErrorMessage>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
+#include <QLabel>
+#include <QListWidget>
 #include <QLCDNumber>
 #include <QMessageBox>
+#include <QMouseEvent>
+#include <QPixmap>
 #include <QTimer>
+#include <QWheelEvent>
 
+// C++ includes
+#include <cmath>
+#include <fstream>
 
-template< class PReader > vtkPolyData *readAnPolyData(const char *fname) {
-  vtkSmartPointer< PReader > reader =
-    vtkSmartPointer< PReader >::New();
-  reader->SetFileName(fname);
-  reader->Update();
-  reader->GetOutput()->Register(reader);
-  return(vtkPolyData::SafeDownCast(reader->GetOutput()));
-  }
 
 basic_QtVTK::basic_QtVTK()
+  : treEstimate(&workerPool)
 {
   this->setupUi(this);
   this->trackerWidget->hide();
+  this->isoSurfaceWidget->hide();
+  this->structuresWidget->hide();
 
+  traceRecorder::setThreadName("GUI");
   createVTKObjects();
   setupVTKObjects();
   setupQTObjects();
     
   ren->ResetCameraClippingRange();
-  this->openGLWidget->GetRenderWindow()->Render();
+  this->render();
 }
 
 
 void basic_QtVTK::createVTKObjects()
 {
   actor = vtkSmartPointer<vtkActor>::New();
+  laserContour = vtkSmartPointer<vtkPolyData>::New();
+  laserContourActor = vtkSmartPointer<vtkActor>::New();
+  collectedPts = vtkSmartPointer<vtkPoints>::New();
   myTracker = vtkSmartPointer< vtkNDITracker >::New();
+  ndiSerialDevice = "/dev/ttyUSB0";
+  registrationMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   ren = vtkSmartPointer<vtkRenderer>::New();
+  toolStatisticsText = vtkSmartPointer<vtkTextActor>::New();
   renWin = vtkSmartPointer<vtkGenericOpenGLRenderWindow>::New();
   stylusActor = vtkSmartPointer<vtkActor>::New();
   trackerDrawing = vtkSmartPointer<vtkImageCanvasSource2D>::New();
   trackerLogoRepresentation = vtkSmartPointer<vtkLogoRepresentation>::New();
   trackerLogoWidget = vtkSmartPointer<vtkLogoWidget>::New();
+  usVolume = vtkSmartPointer<vtkImageData>::New();
   volume = vtkSmartPointer<vtkVolume>::New();
+
+  usRecon.reset(new usReconstructor(&workerPool));
+  usUsesTrackedProbe = false;
+
+  isLaserSlicerOutdated = false;
+  laserStatusTime = 0.0;
+
+  sceneRenderer = nullptr;
+
+  toolStatisticsTextTime = 0.0;
+
+  isoScalarRange[0] = 0.0;
+  isoScalarRange[1] = 1.0;
 }
 
 
 void basic_QtVTK::cleanVTKObjects()
 {
   // if needed
+  usRecon->stop();
+  threadedRendering(false);
+
   if (isTrackerInitialized)
     myTracker->StopTracking();
 }
@@ -158,18 +191,56 @@ void basic_QtVTK::setupVTKObjects()
   screenShotFileNumber = 0;
 
   // tracker
-  this->isTrackerInitialized = isStylusCalibrated = false;
+  this->isTrackerInitialized = isStylusCalibrated = isCollectingPivot = false;
   trackedObjects.push_back(std::make_tuple(4, QString("D://chene//data//NDI_roms//8700248.rom"), enumTrackedObjectTypes::enStylus)); // NDI 3 sphere linear stylus
   trackedObjects.push_back(std::make_tuple(5, QString("D://chene//data//NDI_roms//8700302.rom"), enumTrackedObjectTypes::enOthers)); // NDI 4 sphere planar
+  // the laser contour follows the tool registered as enLaserPlane; none is by default
+  //trackedObjects.push_back(std::make_tuple(6, QString("D://chene//data//NDI_roms//laserPlane.rom"), enumTrackedObjectTypes::enLaserPlane));
+  // freehand ultrasound places the frames with the tool registered as enUSProbe; none is by default
+  //trackedObjects.push_back(std::make_tuple(7, QString("D://chene//data//NDI_roms//usProbe.rom"), enumTrackedObjectTypes::enUSProbe));
 
   this->openGLWidget->SetRenderWindow(renWin);
   
   // VTK Renderer
   ren->SetBackground(.1, .2, .4);
 
+  // laser plane contour, shown while an enLaserPlane tool is tracked
+  vtkNew<vtkPolyDataMapper> laserMapper;
+  laserMapper->SetInputData(laserContour);
+  laserContourActor->SetMapper(laserMapper);
+  laserContourActor->GetProperty()->SetColor(1.0, 0.0, 0.0);
+  laserContourActor->GetProperty()->SetLineWidth(3.0);
+  laserContourActor->GetProperty()->LightingOff();
+  laserContourActor->VisibilityOff();
+  ren->AddActor(laserContourActor);
+
+  // stylus tip trail: the chunks never move, so only the modified ones are re-uploaded
+  for (int i = 0; i < stylusTrail.getNumberOfSlots(); i++)
+    {
+    vtkNew<vtkPolyDataMapper> trailMapper;
+    trailMapper->SetInputData(stylusTrail.getSlot(i));
+    vtkSmartPointer<vtkActor> trailActor = vtkSmartPointer<vtkActor>::New();
+    trailActor->SetMapper(trailMapper);
+    trailActor->GetProperty()->SetColor(1.0, 0.85, 0.0);
+    trailActor->GetProperty()->SetLineWidth(2.0);
+    trailActor->GetProperty()->LightingOff();
+    trailActor->VisibilityOff();
+    ren->AddActor(trailActor);
+    stylusTrailActors.push_back(trailActor);
+    }
+
   // connect VTK with Qt
   this->openGLWidget->GetRenderWindow()->AddRenderer(ren);
 
+  // frames rendered on the render thread are shown here instead of in openGLWidget
+  renderView = new QLabel(centralwidget);
+  renderView->setAlignment(Qt::AlignCenter);
+  renderView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+  renderView->setMinimumSize(1, 1);
+  renderView->installEventFilter(this);
+  verticalLayout->addWidget(renderView);
+  renderView->hide();
+
 }
 
 
@@ -178,6 +249,7 @@ void basic_QtVTK::setupQTObjects()
   connect(action_Background_Color, SIGNAL(triggered()), this, SLOT(editRendererBackgroundColor()));
   connect(action_Quit, SIGNAL(triggered()), this, SLOT(slotExit()));
   connect(actionLoad_Mesh, SIGNAL(triggered()), this, SLOT(loadMesh()));
+  connect(actionLoad_Structures, SIGNAL(triggered()), this, SLOT(loadStructures()));
   connect(actionLoad_Volume, SIGNAL(triggered()), this, SLOT(loadVolume()));
   connect(actionMesh_Color, SIGNAL(triggered()), this, SLOT(editMeshColor()));
   connect(actionScreen_Shot, SIGNAL(triggered()), this, SLOT(screenShot()));
@@ -189,24 +261,58 @@ void basic_QtVTK::setupQTObjects()
   connect(resetPhantomPtButton, SIGNAL(clicked()), this, SLOT(resetPhantomCollectedPoints()));
   connect(deleteOnePhantomPtButton, SIGNAL(clicked()), this, SLOT(deleteOnePhantomCollectedPoints()));
   connect(phantomRegistrationButton, SIGNAL(clicked()), this, SLOT(performPhantomRegistration()));
+  connect(actionUS_Reconstruct_File, SIGNAL(triggered()), this, SLOT(startUSReconstructionFromFile()));
+  connect(actionUS_Reconstruct_Synthetic, SIGNAL(triggered()), this, SLOT(startUSReconstructionSynthetic()));
+  connect(actionUS_Stop_Reconstruction, SIGNAL(triggered()), this, SLOT(stopUSReconstruction()));
+  connect(actionThreaded_Rendering, SIGNAL(toggled(bool)), this, SLOT(threadedRendering(bool)));
+  connect(actionIso_Surface, SIGNAL(toggled(bool)), this, SLOT(isoSurfaceMode(bool)));
+  connect(actionExport_Tracking_Statistics, SIGNAL(triggered()), this, SLOT(exportTrackingStatistics()));
+  connect(actionBinary_Acquisition, SIGNAL(toggled(bool)), this, SLOT(binaryAcquisition(bool)));
+  connect(actionStylus_Trail, SIGNAL(toggled(bool)), this, SLOT(stylusTrailMode(bool)));
+  connect(actionTrail_Last_30_Seconds, SIGNAL(toggled(bool)), this, SLOT(stylusTrailLast30Seconds(bool)));
+  connect(actionClear_Trail, SIGNAL(triggered()), this, SLOT(clearStylusTrail()));
+  connect(actionRecord_Trace, SIGNAL(toggled(bool)), this, SLOT(traceRecording(bool)));
+  connect(actionExport_Trace, SIGNAL(triggered()), this, SLOT(exportTrace()));
+  connect(isoSurfaceSlider, SIGNAL(valueChanged(int)), this, SLOT(isoSurfaceThresholdChanged(int)));
+  connect(structuresList, SIGNAL(itemChanged(QListWidgetItem *)), this, SLOT(structureItemChanged(QListWidgetItem *)));
+  connect(structuresList, SIGNAL(itemDoubleClicked(QListWidgetItem *)), this, SLOT(editStructureColor(QListWidgetItem *)));
+
+  // surfaces are extracted on a worker thread and shown on the GUI thread
+  isoSurface.setSurfaceReadyCallback([this]()
+    {
+    QMetaObject::invokeMethod(this, "showIsoSurface", Qt::QueuedConnection);
+    });
+
+  // refresh the reconstructed volume a few times per second
+  usReconTimer = new QTimer(this);
+  connect(usReconTimer, SIGNAL(timeout()), this, SLOT(updateUSReconstruction()));
 }
 
 void basic_QtVTK::startTracker(bool checked)
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::startTracker");
   if (checked)
     {
     // if tracker is not initialized, do so now
     if (!isTrackerInitialized)
       {
-      myTracker->SetBaudRate(115200); /*!< Set the baud rate sufficiently high. */
+      vtkNDIBinaryTracker *binaryTracker = vtkNDIBinaryTracker::SafeDownCast(myTracker);
+      vtkNDITracker *ndiTracker = vtkNDITracker::SafeDownCast(myTracker);
+      if (ndiTracker)
+        ndiTracker->SetBaudRate(115200); /*!< Set the baud rate sufficiently high. */
       int nMax = myTracker->GetNumberOfTools();
       tools.resize(nMax);
+      toolStats.assign(trackedObjects.size(), toolStatistics());
+      toolLastTimeStamp.assign(trackedObjects.size(), -1.0);
 
       for (int i = 0; i < (int)trackedObjects.size(); i++) 
         {
         int port = std::get<0>(trackedObjects[i]);
         QString romName = std::get<1>(trackedObjects[i]);
-        this->myTracker->LoadVirtualSROM(port, romName.toStdString().c_str());
+        if (binaryTracker)
+          binaryTracker->LoadVirtualSROM(port, romName.toStdString().c_str());
+        else
+          ndiTracker->LoadVirtualSROM(port, romName.toStdString().c_str());
         tools[i] = myTracker->GetTool(port);    
         qDebug() << "Loading" << romName << "into port" << port;
         }
@@ -217,11 +323,13 @@ void basic_QtVTK::startTracker(bool checked)
         qDebug() << "Tracker Initialized";
         statusBar()->showMessage("Tracker Initialized", 5000);
         isTrackerInitialized = true;
+        actionBinary_Acquisition->setEnabled(false); // the tracker cannot be swapped any more
 
         // enable the logo widget to display the status of each tracked object
         this->createTrackerLogo();
         trackerLogoWidget->On();
-        this->openGLWidget->GetRenderWindow()->Render();
+        toolStatisticsText->VisibilityOn();
+        this->render();
 
         // create a QTimer
         trackerTimer = new QTimer(this);
@@ -241,8 +349,12 @@ void basic_QtVTK::startTracker(bool checked)
     if (isTrackerInitialized)
       {
       qDebug() << "Tracking started";
-      statusBar()->showMessage("Tracking started.", 5000);
       myTracker->StartTracking();
+      if (vtkNDIBinaryTracker *binaryTracker = vtkNDIBinaryTracker::SafeDownCast(myTracker))
+        statusBar()->showMessage(QString("Tracking started, binary replies at %1 baud.")
+          .arg(binaryTracker->GetBaudRate()), 5000);
+      else
+        statusBar()->showMessage("Tracking started.", 5000);
       trackerTimer->start(0); // in milli-second. 0 is as fast as we can
       }
     }
@@ -256,7 +368,8 @@ void basic_QtVTK::startTracker(bool checked)
       myTracker->StopTracking();
     
       trackerLogoWidget->Off();
-      this->openGLWidget->GetRenderWindow()->Render();
+      toolStatisticsText->VisibilityOff();
+      this->render();
       statusBar()->showMessage("Tracking stopped.", 5000);
       }
     }
@@ -265,47 +378,111 @@ void basic_QtVTK::startTracker(bool checked)
 
 void basic_QtVTK::updateTrackerInfo()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::updateTrackerInfo");
   if (isTrackerInitialized)
     {
-    myTracker->Update();
+    {
+      AIGS_TRACE_SCOPE("vtkTracker::Update");
+      myTracker->Update();
+    }
 
-    for (int i = 0; i < (int)trackedObjects.size(); i++) 
+    // the timer polls faster than the tracker samples: find the tools with a new sample
+    std::vector<bool> hasNewSample(trackedObjects.size());
+    for (int i = 0; i < (int)trackedObjects.size(); i++)
       {
-      if (tools[i]->IsMissing())
+      double timeStamp = tools[i]->GetTimeStamp();
+      hasNewSample[i] = (timeStamp != toolLastTimeStamp[i]);
+      toolLastTimeStamp[i] = timeStamp;
+      }
+
+    // pivot calibration in progress: accumulate the raw stylus pose, once per tracker sample
+    if (isCollectingPivot)
+      {
+      int idx = findTrackedObject(enumTrackedObjectTypes::enStylus);
+      if (idx >= 0 && hasNewSample[idx] && !tools[idx]->IsMissing() && !tools[idx]->IsOutOfView())
+        stylusPivot.addPose(tools[idx]->GetTransform()->GetMatrix());
+      }
+
+    // freehand ultrasound: feed each new probe pose to the reconstruction, stamped
+    // with the time the tracker took it (tool time stamps are vtkTimerLog universal
+    // time; subtract the age of the sample from the pose clock)
+    if (usRecon->isRunning() && usUsesTrackedProbe)
+      {
+      int idx = findTrackedObject(enumTrackedObjectTypes::enUSProbe);
+      if (idx >= 0 && hasNewSample[idx] && !tools[idx]->IsMissing() && !tools[idx]->IsOutOfView())
         {
-        // not connected, shown in blue
-        trackerDrawing->SetDrawColor(0, 0, 255);
-        trackerDrawing->FillBox(logoWidgetX*i + i + 1, logoWidgetX*(i + 1) + i, 1, logoWidgetY + 1);
+        double sampleAge = vtkTimerLog::GetUniversalTime() - toolLastTimeStamp[idx];
+        usRecon->getPoseBuffer()->addPose(poseClockSeconds() - sampleAge,
+          &tools[idx]->GetTransform()->GetMatrix()->Element[0][0]);
         }
+      }
+
+    // laser plane: re-cut the mesh at the current plane pose
+    int laserIdx = findTrackedObject(enumTrackedObjectTypes::enLaserPlane);
+    if (laserIdx >= 0 && meshData)
+      updateLaserContour(laserIdx);
+
+    int stylusIdx = findTrackedObject(enumTrackedObjectTypes::enStylus);
+    for (int i = 0; i < (int)trackedObjects.size(); i++) 
+      {
+      enumTrackerToolStatus status = enToolOK;
+      if (tools[i]->IsMissing())
+        status = enToolMissing;
       else if (tools[i]->IsOutOfVolume())
-        {
-        // connected, visible but not accurate, shown in yellow
-        trackerDrawing->SetDrawColor(255, 255, 0);
-        trackerDrawing->FillBox(logoWidgetX*i + i + 1, logoWidgetX*(i + 1) + i, 1, logoWidgetY + 1);
-        }
+        status = enToolOutOfVolume;
       else if (tools[i]->IsOutOfView())
+        status = enToolOutOfView;
+
+      drawTrackerToolStatus(trackerDrawing, i, status, logoWidgetX, logoWidgetY);
+
+      // one statistics sample per new tracker sample of the tool
+      if (hasNewSample[i])
         {
-        // connected, visible, but outside of the tracking volume. Shown in red
-        trackerDrawing->SetDrawColor(255, 0, 0);
-        trackerDrawing->FillBox(logoWidgetX*i + i + 1, logoWidgetX*(i + 1) + i, 1, logoWidgetY + 1);
-        }
-      else
-        {
-        // connected and withing good tracking accuracy. shown in green
-        trackerDrawing->SetDrawColor(0, 255, 0);
-        trackerDrawing->FillBox(logoWidgetX*i + i + 1, logoWidgetX*(i + 1) + i, 1, logoWidgetY + 1);
+        double pos[3];
+        tools[i]->GetTransform()->GetPosition(pos);
+        toolStats[i].addSample(toolLastTimeStamp[i], status, pos);
+
+        // the stylus transform includes the tip calibration, so pos is the tip
+        if (i == stylusIdx && actionStylus_Trail->isChecked())
+          {
+          if (status == enToolOK)
+            stylusTrail.addPoint(poseClockSeconds(), pos);
+          else
+            stylusTrail.breakTrail();
+          }
         }
       }
 
-    trackerDrawing->Update();
-    ren->ResetCameraClippingRange();
-    this->openGLWidget->GetRenderWindow()->Render();
+    double now = poseClockSeconds();
+    if (actionStylus_Trail->isChecked())
+      {
+      AIGS_TRACE_SCOPE("toolTrail::update");
+      stylusTrail.update(now);
+      }
+
+    // the text is re-laid out on every change, so refresh it twice a second
+    if (now - toolStatisticsTextTime > 0.5)
+      {
+      toolStatisticsTextTime = now;
+      updateToolStatisticsText();
+      }
+
+    {
+      AIGS_TRACE_SCOPE("trackerDrawing->Update");
+      trackerDrawing->Update();
+    }
+    {
+      AIGS_TRACE_SCOPE("vtkRenderer::ResetCameraClippingRange");
+      ren->ResetCameraClippingRange();
+    }
+    this->render();
     }
 }
 
 
 void basic_QtVTK::loadFiducialPts()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::loadFiducialPts");
   // fiducial is stored as lines of 3 floats
   QString fname = QFileDialog::getOpenFileName(this,
     tr("Open fiducial file"),
@@ -323,38 +500,132 @@ void basic_QtVTK::loadFiducialPts()
 }
 
 
+void basic_QtVTK::loadStructures()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::loadStructures");
+  QStringList fnames = QFileDialog::getOpenFileNames(this,
+    tr("Open segmented structures"),
+    QDir::currentPath(),
+    "PolyData File (*.vtk *.stl *.ply *.obj *.vtp )");
+  if (fnames.isEmpty())
+    return;
+
+  QStringList failed;
+  structuresList->blockSignals(true);
+  for (const QString &fname : fnames)
+    {
+    vtkSmartPointer<vtkPolyData> data = readMeshFile(fname.toStdString());
+    if (!data)
+      {
+      failed << QFileInfo(fname).fileName();
+      continue;
+      }
+
+    // spread the hues of successive structures with the golden ratio
+    int idx = structures.getNumberOfStructures();
+    QColor color = QColor::fromHsvF(std::fmod(0.13 + 0.618034 * idx, 1.0), 0.45, 0.9);
+    double rgb[3] = { color.redF(), color.greenF(), color.blueF() };
+    QString name = QFileInfo(fname).completeBaseName();
+    structures.addStructure(name.toStdString(), data, rgb);
+
+    QListWidgetItem *item = new QListWidgetItem(name, structuresList);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(Qt::Checked);
+    item->setData(Qt::UserRole, idx);
+    item->setData(Qt::DecorationRole, color);
+    }
+  structuresList->blockSignals(false);
+
+  structures.update();
+  updateStructureActors();
+  structuresWidget->show();
+
+  ren->ResetCamera();
+  ren->ResetCameraClippingRange();
+  this->render();
+
+  meshBatcher::statistics stats = structures.getStatistics();
+  statusBar()->showMessage(QString("%1 structures in %2 batches, %3 points (%4 ms)")
+    .arg(stats.numStructures).arg(stats.numBatches).arg(stats.numPoints)
+    .arg(stats.mergeMs, 0, 'f', 0), 5000);
+
+  if (!failed.isEmpty())
+    {
+    QErrorMessage *em = new QErrorMessage(this);
+    em->showMessage(tr("Unsupported or unreadable files: ") + failed.join(", "));
+    }
+}
+
+
+void basic_QtVTK::updateStructureActors()
+{
+  // one actor per batch; batches are only ever added
+  for (int b = (int)structureActors.size(); b < structures.getNumberOfBatches(); b++)
+    {
+    vtkNew<vtkPolyDataMapper> mapper;
+    mapper->SetInputData(structures.getBatch(b));
+    mapper->ScalarVisibilityOn();
+
+    vtkSmartPointer<vtkActor> batchActor = vtkSmartPointer<vtkActor>::New();
+    batchActor->SetMapper(mapper);
+    batchActor->GetProperty()->SetOpacity(structures.getBatchMaterial(b).opacity);
+    batchActor->GetProperty()->SetSpecular(structures.getBatchMaterial(b).specular);
+    batchActor->SetUserMatrix(registrationMatrix); // updated in place by each registration
+    ren->AddActor(batchActor);
+    structureActors.push_back(batchActor);
+    }
+}
+
+
+void basic_QtVTK::structureItemChanged(QListWidgetItem *item)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::structureItemChanged");
+  int idx = item->data(Qt::UserRole).toInt();
+  bool visible = (item->checkState() == Qt::Checked);
+  if (visible == structures.getVisibility(idx))
+    return;
+
+  structures.setVisibility(idx, visible);
+  structures.update();
+  this->render();
+}
+
+
+void basic_QtVTK::editStructureColor(QListWidgetItem *item)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::editStructureColor");
+  int idx = item->data(Qt::UserRole).toInt();
+  double rgb[3];
+  structures.getColor(idx, rgb);
+
+  QColor color = QColorDialog::getColor(QColor::fromRgbF(rgb[0], rgb[1], rgb[2]), this,
+    tr("Colour of ") + item->text());
+  if (!color.isValid())
+    return;
+
+  rgb[0] = color.redF();
+  rgb[1] = color.greenF();
+  rgb[2] = color.blueF();
+  structures.setColor(idx, rgb);
+
+  structuresList->blockSignals(true);
+  item->setData(Qt::DecorationRole, color);
+  structuresList->blockSignals(false);
+  this->render();
+}
+
 void basic_QtVTK::loadVolume()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::loadVolume");
   QString fname = QFileDialog::getOpenFileName(this,
     tr("Open phantom volume"),
     QDir::currentPath(),
     "Volumetric File (*.nrrd *.mhd)");
 
   vtkNew<vtkImageData> imageData;
-  QFileInfo info(fname);
-  bool knownFileType = true;
 
   // parse the file extension for supported volumetric file types.
-  if (info.suffix() == QString(tr("nrrd")))
-  {
-    // .nrrd file type. But it looks like if the compressed format isn't supported.
-    vtkNew<vtkNrrdReader> reader;
-    reader->SetFileName(fname.toStdString().c_str());
-    reader->Update();
-    imageData->ShallowCopy(reader->GetOutput());
-  }
-  else if (info.suffix() == QString(tr("mhd")))
-  {
-    // standard metafile
-    vtkNew<vtkMetaImageReader> reader;
-    reader->SetFileName(fname.toStdString().c_str());
-    reader->Update();
-    imageData->ShallowCopy(reader->GetOutput());
-  }
-  else
-  {
-    knownFileType = false;
-  }
+  bool knownFileType = readVolumeFile(fname.toStdString(), imageData);
 
   if (knownFileType) // only do something if the file type is known.
   {
@@ -362,6 +633,7 @@ void basic_QtVTK::loadVolume()
     vtkNew<vtkSmartVolumeMapper> mapper;
     mapper->SetBlendModeToComposite();
     mapper->SetInputData(imageData);
+    traceVolumeMapper(mapper);
 
     // define the appearance of the volume
     vtkNew<vtkVolumeProperty> volumeProperty;
@@ -394,15 +666,23 @@ void basic_QtVTK::loadVolume()
 
     ren->AddVolume(volume);
 
+    // the iso-surface slider spans the scalar range of the new volume
+    volumeData = imageData.GetPointer();
+    volumeData->GetScalarRange(isoScalarRange);
+    isoSurface.setInput(volumeData);
+    if (actionIso_Surface->isChecked())
+      isoSurfaceThresholdChanged(isoSurfaceSlider->value());
+
     // reset the camera according to visible actors
     ren->ResetCamera();
     ren->ResetCameraClippingRange();
-    this->openGLWidget->GetRenderWindow()->Render();
+    this->render();
   }
 }
 
 void basic_QtVTK::loadMesh()
   {
+  AIGS_TRACE_SCOPE("basic_QtVTK::loadMesh");
   QString fname = QFileDialog::getOpenFileName(this,
     tr("Open phantom mesh"),
     QDir::currentPath(),
@@ -410,38 +690,10 @@ void basic_QtVTK::loadMesh()
 
   // std::cerr << fname.toStdString().c_str() << std::endl;
 
-  vtkPolyData *data;
-
-  QFileInfo info(fname);
-  bool knownFileType = true;
-
   // parse the file extension and use the appropriate reader
-  if (info.suffix() == QString(tr("vtk")))
-    {
-    data = readAnPolyData<vtkPolyDataReader >(fname.toStdString().c_str());
-    }
-  else if (info.suffix() == QString(tr("stl")) || info.suffix() == QString(tr("stlb")))
-    {
-    data = readAnPolyData<vtkSTLReader>(fname.toStdString().c_str());
-    }
-  else if (info.suffix() == QString(tr("ply")))
-    {
-    data = readAnPolyData<vtkPLYReader>(fname.toStdString().c_str());
-    }
-  else if (info.suffix() == QString(tr("obj")))
-    {
-    data = readAnPolyData<vtkOBJReader>(fname.toStdString().c_str());
-    }
-  else if (info.suffix() == QString(tr("vtp")))
-    {
-    data = readAnPolyData<vtkXMLPolyDataReader>(fname.toStdString().c_str());
-    }
-  else
-    {
-    knownFileType = false;
-    }
+  vtkSmartPointer<vtkPolyData> data = readMeshFile(fname.toStdString());
 
-  if (knownFileType)
+  if (data)
     {
     // do something only if we know the file type
     vtkNew<vtkPolyDataMapper> mapper;
@@ -450,10 +702,14 @@ void basic_QtVTK::loadMesh()
     actor->SetMapper(mapper);
     ren->AddActor(actor);
 
+    // the laser plane slicer re-indexes the new mesh on its next update
+    meshData = data;
+    isLaserSlicerOutdated = true;
+
     // reset the camera according to visible actors
     ren->ResetCamera();
     ren->ResetCameraClippingRange();
-    this->openGLWidget->GetRenderWindow()->Render();
+    this->render();
     }
   else
     {
@@ -465,26 +721,13 @@ void basic_QtVTK::loadMesh()
 
 void basic_QtVTK::stylusCalibration(bool checked)
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::stylusCalibration");
   // assumes that there is only 1 stylus among all the tracked objects
 
   // make sure the tracker is initialized/found first.
-  if (isTrackerInitialized)
+  int toolIdx = findTrackedObject(enumTrackedObjectTypes::enStylus);
+  if (isTrackerInitialized && toolIdx >= 0)
     {
-    // find out which port is the stylus
-    int stylusPort = -1;
-    int toolIdx = -1;
-    for (int i = 0; i < (int)trackedObjects.size(); i++)
-      {
-      int port = std::get<0>(trackedObjects[i]);
-      enumTrackedObjectTypes myType = std::get<2>(trackedObjects[i]);
-
-      if (myType == enumTrackedObjectTypes::enStylus)
-        {
-        stylusPort = port;
-        toolIdx = i;
-        }
-      }
-
     if (checked)
       {
       qDebug() << "Starting pivot calibration";
@@ -495,18 +738,35 @@ void basic_QtVTK::stylusCalibration(bool checked)
       vtkNew<vtkMatrix4x4> matrix;
       matrix->DeepCopy(m);
 
-      qDebug() << "stylus port:" << stylusPort << "index:" << toolIdx;
+      qDebug() << "stylus port:" << std::get<0>(trackedObjects[toolIdx]) << "index:" << toolIdx;
       tools[toolIdx]->SetCalibrationMatrix(matrix);
-      tools[toolIdx]->InitializeToolTipCalibration();
-      tools[toolIdx]->SetCollectToolTipCalibrationData(1);
+
+      // poses are accumulated in updateTrackerInfo()
+      stylusPivot.reset();
+      isCollectingPivot = true;
       }
     else
       {
-      tools[toolIdx]->SetCollectToolTipCalibrationData(0);
-      this->stylusTipRMS->display(tools[toolIdx]->DoToolTipCalibration());
+      isCollectingPivot = false;
+
+      double tip[3], pivot[3];
+      double rms = stylusPivot.solve(tip, pivot);
+      if (rms < 0.0)
+        {
+        statusBar()->showMessage(tr("Pivot calibration failed: not enough stylus poses."), 5000);
+        return;
+        }
+
+      // the calibrated tool frame has its origin at the stylus tip
+      vtkNew<vtkMatrix4x4> matrix;
+      matrix->SetElement(0, 3, tip[0]);
+      matrix->SetElement(1, 3, tip[1]);
+      matrix->SetElement(2, 3, tip[2]);
+      tools[toolIdx]->SetCalibrationMatrix(matrix);
+
+      this->stylusTipRMS->display(rms);
       isStylusCalibrated = true;
-      qDebug() << "Pivot calibration finished";
-      // tools[toolIdx]->Print(std::cerr);
+      qDebug() << "Pivot calibration finished with" << stylusPivot.getNumberOfPoses() << "poses";
       createLinearZStylusActor();
       }
     }
@@ -540,11 +800,23 @@ void basic_QtVTK::createTrackerLogo()
 
   trackerLogoWidget->SetRepresentation(trackerLogoRepresentation);
   trackerLogoWidget->SetInteractor(this->openGLWidget->GetInteractor());
+
+  // per-tool statistics, to the right of the logo
+  toolStatisticsText->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
+  toolStatisticsText->SetPosition(.56, .005);
+  toolStatisticsText->GetTextProperty()->SetFontFamilyToCourier();
+  toolStatisticsText->GetTextProperty()->SetFontSize(12);
+  toolStatisticsText->GetTextProperty()->SetColor(1.0, 1.0, 1.0);
+  toolStatisticsText->GetTextProperty()->SetBackgroundColor(0.0, 0.0, 0.0);
+  toolStatisticsText->GetTextProperty()->SetBackgroundOpacity(0.4);
+  toolStatisticsText->SetInput(" ");
+  ren->AddActor2D(toolStatisticsText);
 }
 
 
 void basic_QtVTK::screenShot()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::screenShot");
   // output the screen to PNG files.
   //
   // the file names are 0.png, 1.png, ..., etc.
@@ -552,24 +824,17 @@ void basic_QtVTK::screenShot()
   QString fname = QString::number(screenShotFileNumber) + QString(tr(".png"));
   screenShotFileNumber++;
 
-  vtkNew<vtkWindowToImageFilter> w2i;
-  w2i->SetInput(this->openGLWidget->GetRenderWindow());
-  w2i->ReadFrontBufferOff();
-  w2i->SetInputBufferTypeToRGBA();
-
-  vtkNew<vtkImageExtractComponents> iec;
-  iec->SetInputConnection(w2i->GetOutputPort());
-  iec->SetComponents(0, 1, 2);
-
-  vtkNew<vtkPNGWriter> writer;
-  writer->SetFileName(fname.toStdString().c_str());
-  writer->SetInputConnection(iec->GetOutputPort());
-  writer->Write();
+  // the GUI window is not rendered while the render thread is running
+  if (sceneRenderer)
+    lastRenderedFrame.save(fname, "PNG");
+  else
+    writeScreenShotPNG(this->openGLWidget->GetRenderWindow(), fname.toStdString().c_str());
 }
 
 
 void basic_QtVTK::editRendererBackgroundColor()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::editRendererBackgroundColor");
   QColor color = QColorDialog::getColor(Qt::gray, this);
 
   if (color.isValid())
@@ -577,13 +842,14 @@ void basic_QtVTK::editRendererBackgroundColor()
     int r, g, b;
     color.getRgb(&r, &g, &b);
     ren->SetBackground((double)r / 255.0, (double)g / 255.0, (double)b / 255.0);
-    this->openGLWidget->GetRenderWindow()->Render();
+    this->render();
     }
 }
 
 
 void basic_QtVTK::editMeshColor()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::editMeshColor");
   QColor color = QColorDialog::getColor(Qt::gray, this);
 
   if (color.isValid())
@@ -591,7 +857,10 @@ void basic_QtVTK::editMeshColor()
     int r, g, b;
     color.getRgb(&r, &g, &b);
     actor->GetProperty()->SetColor((double)r / 255.0, (double)g / 255.0, (double)b / 255.0);
-    this->openGLWidget->GetRenderWindow()->Render();
+    // a solid colour replaces the TRE map, if any
+    if (actor->GetMapper())
+      actor->GetMapper()->ScalarVisibilityOff();
+    this->render();
     }  
 }
 
@@ -690,26 +959,682 @@ void basic_QtVTK::createLinearZStylusActor()
 
 void basic_QtVTK::collectSinglePointPhantom()
 {
-  qDebug() << "collect";
+  AIGS_TRACE_SCOPE("basic_QtVTK::collectSinglePointPhantom");
+  int toolIdx = findTrackedObject(enumTrackedObjectTypes::enStylus);
+  if (!isTrackerInitialized || !isStylusCalibrated || toolIdx < 0)
+    {
+    statusBar()->showMessage(tr("Calibrate the stylus before collecting fiducials."), 5000);
+    return;
+    }
+
+  if (tools[toolIdx]->IsMissing() || tools[toolIdx]->IsOutOfView())
+    {
+    statusBar()->showMessage(tr("Stylus is not visible."), 5000);
+    return;
+    }
+
+  // the calibrated stylus has its origin at the tip
+  double pos[3];
+  tools[toolIdx]->GetTransform()->GetPosition(pos);
+  collectedPts->InsertNextPoint(pos);
+  collectedPts->Modified();
+
+  qDebug() << "collected" << pos[0] << pos[1] << pos[2];
+  this->numCollected->display((int)collectedPts->GetNumberOfPoints());
 }
 
 
 void basic_QtVTK::resetPhantomCollectedPoints()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::resetPhantomCollectedPoints");
+  collectedPts->Reset();
+  collectedPts->Modified();
 
+  this->numCollected->display(0);
+  this->FRE->display(0);
   qDebug() << "reset";
 }
 
 
 void basic_QtVTK::deleteOnePhantomCollectedPoints()
 {
+  AIGS_TRACE_SCOPE("basic_QtVTK::deleteOnePhantomCollectedPoints");
+  vtkIdType n = collectedPts->GetNumberOfPoints();
+  if (n == 0)
+    return;
+
+  vtkNew<vtkPoints> remaining;
+  for (vtkIdType i = 0; i < n - 1; i++)
+    remaining->InsertNextPoint(collectedPts->GetPoint(i));
+  collectedPts->DeepCopy(remaining);
 
+  this->numCollected->display((int)collectedPts->GetNumberOfPoints());
   qDebug() << "delete";
 }
 
 
 void basic_QtVTK::performPhantomRegistration()
 {
-  qDebug() << "register";
+  AIGS_TRACE_SCOPE("basic_QtVTK::performPhantomRegistration");
+  // the read (.xyz) fiducials are the source, the collected ones the target
+  if (!fiducialPts || fiducialPts->GetNumberOfPoints() != collectedPts->GetNumberOfPoints() ||
+    collectedPts->GetNumberOfPoints() < 3)
+    {
+    QErrorMessage *em = new QErrorMessage(this);
+    em->showMessage("Registration needs at least 3 collected points, one for every loaded fiducial");
+    return;
+    }
+
+  double fre = landmarkRegistration(fiducialPts, collectedPts, registrationMatrix);
+  this->FRE->display(fre);
+  qDebug() << "register, FRE:" << fre;
+
+  // bring the phantom into tracker space; the structure actors already share registrationMatrix
+  actor->SetUserMatrix(registrationMatrix);
+  volume->SetUserMatrix(registrationMatrix);
+
+  estimateTRE(fre);
+
+  ren->ResetCameraClippingRange();
+  this->render();
+}
+
+
+void basic_QtVTK::estimateTRE(double fre)
+{
+  int n = (int)fiducialPts->GetNumberOfPoints();
+  std::vector<double> source(3 * n), target(3 * n);
+  for (int i = 0; i < n; i++)
+    {
+    fiducialPts->GetPoint(i, &source[3 * i]);
+    collectedPts->GetPoint(i, &target[3 * i]);
+    }
+
+  // perturb with the measured stylus jitter if enough static samples were seen,
+  // otherwise infer the fiducial localization error from the FRE
+  double fleSigma = treEstimator::fleSigmaFromFRE(fre, n);
+  QString sigmaSource = tr("from FRE");
+  int stylusIdx = findTrackedObject(enumTrackedObjectTypes::enStylus);
+  if (stylusIdx >= 0 && stylusIdx < (int)toolStats.size())
+    {
+    toolStatistics::summary stylusStats = toolStats[stylusIdx].getSummary(vtkTimerLog::GetUniversalTime());
+    if (stylusStats.pooledSamples >= toolStatistics::minStaticSamples)
+      {
+      fleSigma = stylusStats.pooledSigma;
+      sigmaSource = tr("measured");
+      }
+    }
+  if (!treEstimate.estimate(source.data(), target.data(), n, fleSigma))
+    return;
+
+  if (!meshData)
+    {
+    const treEstimator::statistics &stats = treEstimate.getStatistics();
+    statusBar()->showMessage(QString("TRE: %1 trials, FLE sigma %2 mm (%3), %4 ms. Load a mesh to map it.")
+      .arg(stats.numTrials).arg(stats.fleSigma, 0, 'f', 3).arg(sigmaSource)
+      .arg(stats.estimateMs, 0, 'f', 0), 10000);
+    return;
+    }
+
+  // colour the mesh by TRE, blue (low) to red (high)
+  vtkNew<vtkFloatArray> tre;
+  treEstimate.computeTREMap(meshData, tre);
+  meshData->GetPointData()->AddArray(tre);
+  meshData->GetPointData()->SetActiveScalars("TRE");
+
+  const treEstimator::statistics &stats = treEstimate.getStatistics();
+  vtkNew<vtkLookupTable> lut;
+  lut->SetHueRange(0.667, 0.0);
+  lut->Build();
+
+  vtkMapper *mapper = actor->GetMapper();
+  mapper->SetLookupTable(lut);
+  mapper->SetScalarRange(0.0, stats.maxTRE > 0.0 ? stats.maxTRE : 1.0);
+  mapper->SetScalarModeToUsePointData();
+  mapper->ScalarVisibilityOn();
+
+  qDebug() << "TRE:" << stats.numTrials << "trials," << "FLE sigma" << stats.fleSigma << "mm, mean"
+    << stats.meanTRE << "max" << stats.maxTRE << "mm," << stats.estimateMs + stats.mapMs << "ms";
+  statusBar()->showMessage(QString("TRE over %1 vertices: mean %2 mm, max %3 mm "
+    "(FLE sigma %4 mm %5, %6 trials, %7 ms)")
+    .arg(stats.numTargets).arg(stats.meanTRE, 0, 'f', 2).arg(stats.maxTRE, 0, 'f', 2)
+    .arg(stats.fleSigma, 0, 'f', 3).arg(sigmaSource)
+    .arg(stats.numTrials).arg(stats.estimateMs + stats.mapMs, 0, 'f', 0), 10000);
+}
+
+
+int basic_QtVTK::findTrackedObject(enumTrackedObjectTypes type) const
+{
+  for (int i = 0; i < (int)trackedObjects.size(); i++)
+    {
+    if (std::get<2>(trackedObjects[i]) == type)
+      return i;
+    }
+
+  return -1;
+}
+
+
+void basic_QtVTK::startUSReconstructionFromFile()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::startUSReconstructionFromFile");
+  QString fname = QFileDialog::getOpenFileName(this,
+    tr("Open ultrasound frame stream"),
+    QDir::currentPath(),
+    "Ultrasound Frames (*.usraw)");
+  if (fname.isEmpty())
+    return;
+
+  std::unique_ptr<usFileFrameSource> source(new usFileFrameSource(fname.toStdString()));
+  if (!source->isValid())
+    {
+    QErrorMessage *em = new QErrorMessage(this);
+    em->showMessage("Not an ultrasound frame stream");
+    return;
+    }
+
+  if (!isTrackerInitialized || findTrackedObject(enumTrackedObjectTypes::enUSProbe) < 0)
+    statusBar()->showMessage(tr("No tracked US probe: frames cannot be placed until one is tracked."), 5000);
+
+  startUSReconstruction(std::move(source), true);
+}
+
+
+void basic_QtVTK::startUSReconstructionSynthetic()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::startUSReconstructionSynthetic");
+  // 640x480 at 30 fps, sweeping over a sphere at the origin
+  startUSReconstruction(std::unique_ptr<usFrameSource>(new usSyntheticFrameSource(640, 480, 30.0)), false);
+}
+
+
+void basic_QtVTK::startUSReconstruction(std::unique_ptr<usFrameSource> source, bool useTrackedProbe)
+{
+  usRecon->stop();
+
+  // 128 mm cube at 0.5 mm, centred on the probe if it is tracked
+  double origin[3] = { -64.0, -64.0, -64.0 };
+  const double spacing[3] = { 0.5, 0.5, 0.5 };
+  const int dims[3] = { 256, 256, 256 };
+
+  int probeIdx = findTrackedObject(enumTrackedObjectTypes::enUSProbe);
+  if (useTrackedProbe && isTrackerInitialized && probeIdx >= 0 && !tools[probeIdx]->IsMissing())
+    {
+    double pos[3];
+    tools[probeIdx]->GetTransform()->GetPosition(pos);
+    for (int i = 0; i < 3; i++)
+      origin[i] += pos[i];
+    }
+
+  usRecon->setOutputGeometry(origin, spacing, dims);
+  usUsesTrackedProbe = useTrackedProbe;
+  usRecon->start(std::move(source));
+  usRecon->updateOutput(usVolume);
+
+  // show the growing volume through the same volume actor as loadVolume()
+  vtkNew<vtkSmartVolumeMapper> mapper;
+  mapper->SetBlendModeToComposite();
+  mapper->SetInputData(usVolume);
+  traceVolumeMapper(mapper);
+
+  vtkNew<vtkVolumeProperty> volumeProperty;
+  volumeProperty->ShadeOff();
+  volumeProperty->SetInterpolationTypeToLinear();
+
+  vtkNew<vtkPiecewiseFunction> compositeOpacity;
+  compositeOpacity->AddPoint(0, 0.0);
+  compositeOpacity->AddPoint(60, 0.0);
+  compositeOpacity->AddPoint(255, 0.8);
+  volumeProperty->SetScalarOpacity(compositeOpacity);
+
+  vtkNew<vtkColorTransferFunction> color;
+  color->AddRGBPoint(0, 0, 0, 0);
+  color->AddRGBPoint(255, 1, 1, 1);
+  volumeProperty->SetColor(color);
+
+  volume->SetMapper(mapper);
+  volume->SetProperty(volumeProperty);
+  volume->SetUserMatrix(nullptr); // reconstructed in tracker space
+  ren->AddVolume(volume);
+
+  ren->ResetCamera();
+  ren->ResetCameraClippingRange();
+  this->render();
+
+  usReconTimer->start(200);
+  statusBar()->showMessage(tr("Ultrasound reconstruction started."), 5000);
+}
+
+
+void basic_QtVTK::stopUSReconstruction()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::stopUSReconstruction");
+  if (!usRecon->isRunning())
+    return;
+
+  usReconTimer->stop();
+  usRecon->stop();
+  updateUSReconstruction();
+}
+
+
+void basic_QtVTK::updateUSReconstruction()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::updateUSReconstruction");
+  // end of a recorded stream
+  if (usRecon->isRunning() && !usRecon->isAcquiring())
+    {
+    usReconTimer->stop();
+    usRecon->stop();
+    }
+
+  usRecon->updateOutput(usVolume);
+  this->render();
+
+  usReconstructor::statistics stats = usRecon->getStatistics();
+  statusBar()->showMessage(QString("US frames: %1 received, %2 inserted, %3 without pose, "
+    "queue %4 (max %5), %6 fps")
+    .arg(stats.framesReceived).arg(stats.framesInserted).arg(stats.framesWithoutPose)
+    .arg(stats.queueLength).arg(stats.maxQueueLength).arg(stats.insertionFPS, 0, 'f', 1));
+}
+
+
+void basic_QtVTK::updateLaserContour(int toolIdx)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::updateLaserContour");
+  if (tools[toolIdx]->IsMissing() || tools[toolIdx]->IsOutOfView())
+    {
+    laserContourActor->VisibilityOff();
+    return;
+    }
+
+  if (isLaserSlicerOutdated)
+    {
+    laserSlicer.setMesh(meshData);
+    isLaserSlicerOutdated = false;
+    qDebug() << "laser slicer: indexed" << laserSlicer.getStatistics().numTriangles
+      << "triangles in" << laserSlicer.getStatistics().buildMs << "ms";
+    }
+
+  // tool -> mesh: the mesh is placed in tracker space by the actor's user matrix
+  vtkNew<vtkMatrix4x4> toolToMesh;
+  toolToMesh->DeepCopy(tools[toolIdx]->GetTransform()->GetMatrix());
+  if (vtkMatrix4x4 *meshToTracker = actor->GetUserMatrix())
+    {
+    vtkNew<vtkMatrix4x4> trackerToMesh;
+    vtkMatrix4x4::Invert(meshToTracker, trackerToMesh);
+    vtkMatrix4x4::Multiply4x4(trackerToMesh, toolToMesh, toolToMesh);
+    }
+
+  // the laser fan spans the tool x-z plane: origin at the tool origin, normal along tool y
+  double origin[3], normal[3];
+  for (int i = 0; i < 3; i++)
+    {
+    origin[i] = toolToMesh->GetElement(i, 3);
+    normal[i] = toolToMesh->GetElement(i, 1);
+    }
 
-}
\ No newline at end of file
+  laserSlicer.slice(origin, normal, laserContour);
+  laserContourActor->SetUserMatrix(actor->GetUserMatrix());
+  laserContourActor->VisibilityOn();
+
+  // report the cost about once a second; the tracker loop runs much faster
+  double now = poseClockSeconds();
+  if (now - laserStatusTime > 1.0)
+    {
+    laserStatusTime = now;
+    const planeMeshSlicer::statistics &stats = laserSlicer.getStatistics();
+    statusBar()->showMessage(QString("Laser contour: %1 segments, %2 of %3 triangles tested, "
+      "%4 ms (mean %5 ms)")
+      .arg(stats.segments).arg(stats.trianglesTested).arg(stats.numTriangles)
+      .arg(stats.sliceMs, 0, 'f', 3).arg(stats.meanSliceMs, 0, 'f', 3), 2000);
+    }
+}
+
+
+void basic_QtVTK::render()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::render");
+  if (sceneRenderer)
+    {
+    // snapshot the scene and let the render thread draw it
+    qreal ratio = renderView->devicePixelRatioF();
+    sceneCapture.capture(ren, (int)(renderView->width() * ratio), (int)(renderView->height() * ratio), sceneState);
+    sceneRenderer->submit(sceneState);
+    }
+  else
+    {
+    AIGS_TRACE_SCOPE("vtkRenderWindow::Render");
+    this->openGLWidget->GetRenderWindow()->Render();
+    }
+}
+
+
+void basic_QtVTK::threadedRendering(bool checked)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::threadedRendering");
+  if (checked && !sceneRenderer)
+    {
+    sceneRenderer = new renderThread(this);
+    connect(sceneRenderer, SIGNAL(frameReady()), this, SLOT(showRenderedFrame()));
+    sceneRenderer->start();
+
+    this->openGLWidget->hide();
+    renderView->show();
+    this->render();
+    statusBar()->showMessage(tr("Rendering on a separate thread."), 5000);
+    }
+  else if (!checked && sceneRenderer)
+    {
+    renderThread::statistics stats = sceneRenderer->getStatistics();
+    qDebug() << "render thread:" << stats.framesRendered << "frames, mean" << stats.meanFrameMs
+      << "ms," << stats.snapshotsDropped << "snapshots replaced before rendering";
+
+    sceneRenderer->stop();
+    delete sceneRenderer;
+    sceneRenderer = nullptr;
+    sceneCapture.clear();
+    sceneState = renderSceneState();
+
+    renderView->hide();
+    this->openGLWidget->show();
+    this->render();
+    }
+}
+
+
+void basic_QtVTK::showRenderedFrame()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::showRenderedFrame");
+  if (!sceneRenderer)
+    return;
+
+  lastRenderedFrame = sceneRenderer->takeFrame();
+  lastRenderedFrame.setDevicePixelRatio(renderView->devicePixelRatioF());
+  renderView->setPixmap(QPixmap::fromImage(lastRenderedFrame));
+}
+
+
+bool basic_QtVTK::eventFilter(QObject *obj, QEvent *event)
+{
+  if (obj != renderView || !sceneRenderer)
+    return QMainWindow::eventFilter(obj, event);
+
+  // camera interaction for the render thread view, after vtkInteractorStyleTrackballCamera:
+  // left button rotates, middle button pans, right button and wheel zoom
+  vtkCamera *camera = ren->GetActiveCamera();
+  switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+      lastMousePos = static_cast<QMouseEvent *>(event)->pos();
+      return true;
+
+    case QEvent::MouseMove:
+      {
+      QMouseEvent *e = static_cast<QMouseEvent *>(event);
+      double dx = e->pos().x() - lastMousePos.x();
+      double dy = e->pos().y() - lastMousePos.y(); // Qt y points down
+      lastMousePos = e->pos();
+
+      if (e->buttons() & Qt::LeftButton)
+        {
+        camera->Azimuth(-200.0 * dx / renderView->width());
+        camera->Elevation(200.0 * dy / renderView->height());
+        camera->OrthogonalizeViewUp();
+        }
+      else if (e->buttons() & Qt::MiddleButton)
+        {
+        // move the camera and focal point in the view plane, one pixel per pixel at the focal point
+        double pos[3], fp[3], up[3], dir[3], right[3];
+        camera->GetPosition(pos);
+        camera->GetFocalPoint(fp);
+        camera->GetViewUp(up);
+        camera->GetDirectionOfProjection(dir);
+        vtkMath::Cross(dir, up, right);
+        double mmPerPixel = 2.0 * camera->GetDistance() *
+          std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle() / 2.0)) / renderView->height();
+        for (int i = 0; i < 3; i++)
+          {
+          double d = (-dx * right[i] + dy * up[i]) * mmPerPixel;
+          pos[i] += d;
+          fp[i] += d;
+          }
+        camera->SetPosition(pos);
+        camera->SetFocalPoint(fp);
+        }
+      else if (e->buttons() & Qt::RightButton)
+        {
+        camera->Dolly(std::pow(1.1, -10.0 * dy / renderView->height()));
+        }
+      else
+        {
+        return true;
+        }
+      this->render();
+      return true;
+      }
+
+    case QEvent::Wheel:
+      camera->Dolly(std::pow(1.1, static_cast<QWheelEvent *>(event)->angleDelta().y() / 120.0));
+      this->render();
+      return true;
+
+    case QEvent::Resize:
+      this->render();
+      return false;
+
+    default:
+      return QMainWindow::eventFilter(obj, event);
+    }
+}
+
+
+void basic_QtVTK::isoSurfaceMode(bool checked)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::isoSurfaceMode");
+  isoSurfaceWidget->setVisible(checked);
+
+  // the volume would hide the surface inside it
+  volume->SetVisibility(!checked);
+  if (checked)
+    isoSurfaceThresholdChanged(isoSurfaceSlider->value());
+  else
+    this->render();
+}
+
+
+void basic_QtVTK::isoSurfaceThresholdChanged(int value)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::isoSurfaceThresholdChanged");
+  double threshold = isoScalarRange[0] +
+    (isoScalarRange[1] - isoScalarRange[0]) * value / isoSurfaceSlider->maximum();
+  isoSurfaceValue->setText(QString::number(threshold, 'g', 5));
+
+  if (volumeData && actionIso_Surface->isChecked())
+    isoSurface.requestSurface(threshold);
+}
+
+
+void basic_QtVTK::showIsoSurface()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::showIsoSurface");
+  double threshold;
+  vtkSmartPointer<vtkPolyData> surface;
+  if (!isoSurface.takeSurface(threshold, surface))
+    return;
+
+  // cached surfaces are shared: work on a shallow copy, so that e.g. the TRE map stays local
+  vtkNew<vtkPolyData> data;
+  data->ShallowCopy(surface);
+
+  bool firstSurface = !ren->HasViewProp(actor);
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(data);
+  actor->SetMapper(mapper);
+  ren->AddActor(actor);
+
+  // the surface replaces the loaded mesh for the laser contour and TRE map
+  meshData = data.GetPointer();
+  isLaserSlicerOutdated = true;
+
+  if (firstSurface)
+    ren->ResetCamera();
+  ren->ResetCameraClippingRange();
+  this->render();
+
+  isoSurfaceExtractor::statistics stats = isoSurface.getStatistics();
+  statusBar()->showMessage(QString("Iso-surface at %1: %2 triangles, %3")
+    .arg(threshold, 0, 'g', 5).arg(stats.numTriangles)
+    .arg(stats.extractMs > 0.0 ? QString("%1 ms").arg(stats.extractMs, 0, 'f', 0)
+      : QString("cached")), 5000);
+}
+
+
+QString basic_QtVTK::trackedObjectName(int idx) const
+{
+  return QString("%1 (port %2)").arg(QFileInfo(std::get<1>(trackedObjects[idx])).completeBaseName())
+    .arg(std::get<0>(trackedObjects[idx]));
+}
+
+
+void basic_QtVTK::updateToolStatisticsText()
+{
+  // the tool time stamps are on the vtkTimerLog universal clock
+  double now = vtkTimerLog::GetUniversalTime();
+  QString text;
+  for (int i = 0; i < (int)toolStats.size(); i++)
+    {
+    toolStatistics::summary s = toolStats[i].getSummary(now);
+    if (i > 0)
+      text += "\n";
+    text += QString("%1: %2 Hz  dt p95 %3 ms  jitter %4 mm  drops %5")
+      .arg(std::get<0>(trackedObjects[i]), 2)
+      .arg(s.sampleRateHz, 5, 'f', 1)
+      .arg(s.intervalP95Ms, 5, 'f', 1)
+      .arg(s.staticSamples > 1 ? QString::number(s.jitterRMS, 'f', 3) : QString("  -  "))
+      .arg(s.dropouts);
+    }
+  toolStatisticsText->SetInput(text.isEmpty() ? " " : text.toStdString().c_str());
+}
+
+
+void basic_QtVTK::exportTrackingStatistics()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::exportTrackingStatistics");
+  if (toolStats.empty())
+    {
+    statusBar()->showMessage(tr("No tracking statistics: start the tracker first."), 5000);
+    return;
+    }
+
+  QString fname = QFileDialog::getSaveFileName(this,
+    tr("Export tracking statistics"),
+    QDir::currentPath(),
+    "CSV File (*.csv)");
+  if (fname.isEmpty())
+    return;
+
+  std::vector<std::string> names;
+  std::vector<toolStatistics::summary> summaries;
+  double now = vtkTimerLog::GetUniversalTime();
+  for (int i = 0; i < (int)toolStats.size(); i++)
+    {
+    names.push_back(trackedObjectName(i).toStdString());
+    summaries.push_back(toolStats[i].getSummary(now));
+    }
+
+  std::ofstream os(fname.toStdString().c_str());
+  writeToolStatisticsCSV(os, names, summaries);
+  if (os)
+    statusBar()->showMessage(tr("Tracking statistics saved to ") + fname, 5000);
+  else
+    statusBar()->showMessage(tr("Could not write ") + fname, 5000);
+}
+
+
+void basic_QtVTK::binaryAcquisition(bool checked)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::binaryAcquisition");
+  if (isTrackerInitialized)
+    return;
+
+  if (checked)
+    {
+    bool ok;
+    QString device = QInputDialog::getText(this, tr("Binary acquisition"),
+      tr("Serial device of the tracking system (or of the NDI emulator):"),
+      QLineEdit::Normal, ndiSerialDevice, &ok);
+    if (!ok || device.isEmpty())
+      {
+      actionBinary_Acquisition->setChecked(false);
+      return;
+      }
+    ndiSerialDevice = device;
+
+    vtkSmartPointer<vtkNDIBinaryTracker> binaryTracker = vtkSmartPointer<vtkNDIBinaryTracker>::New();
+    binaryTracker->SetSerialDevice(ndiSerialDevice.toStdString().c_str());
+    myTracker = binaryTracker;
+    }
+  else
+    {
+    myTracker = vtkSmartPointer<vtkNDITracker>::New();
+    }
+}
+
+
+void basic_QtVTK::stylusTrailMode(bool checked)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::stylusTrailMode");
+  // the trail restarts where the stylus is when it is turned back on
+  if (checked)
+    stylusTrail.breakTrail();
+  for (vtkActor *trailActor : stylusTrailActors)
+    trailActor->SetVisibility(checked);
+  this->render();
+}
+
+
+void basic_QtVTK::stylusTrailLast30Seconds(bool checked)
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::stylusTrailLast30Seconds");
+  stylusTrail.setTimeWindow(checked ? 30.0 : 0.0);
+  stylusTrail.update(poseClockSeconds());
+  this->render();
+}
+
+
+void basic_QtVTK::clearStylusTrail()
+{
+  AIGS_TRACE_SCOPE("basic_QtVTK::clearStylusTrail");
+  stylusTrail.clear();
+  stylusTrail.update(poseClockSeconds());
+  this->render();
+}
+
+
+void basic_QtVTK::traceRecording(bool checked)
+{
+  // each recording starts from an empty trace
+  if (checked)
+    traceRecorder::clear();
+  traceRecorder::setEnabled(checked);
+  statusBar()->showMessage(checked ? tr("Recording a trace of the hot paths.") : tr("Trace recording stopped."), 5000);
+}
+
+
+void basic_QtVTK::exportTrace()
+{
+  QString fname = QFileDialog::getSaveFileName(this,
+    tr("Export trace"),
+    QDir::currentPath(),
+    "Chrome Trace (*.json)");
+  if (fname.isEmpty())
+    return;
+
+  std::ofstream os(fname.toStdString().c_str());
+  long long numEvents = traceRecorder::writeChromeTrace(os);
+  if (os)
+    statusBar()->showMessage(QString("%1 trace events saved to %2").arg(numEvents).arg(fname), 5000);
+  else
+    statusBar()->showMessage(tr("Could not write ") + fname, 5000);
+}
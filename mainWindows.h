@@ -52,26 +52,49 @@ POSSIBILITY OF SUCH DAMAGES.
 #include <QMainWindow>
 #include "ui_basic_QtVTK_AIGS.h"
 
+// local includes
+#include "isoSurfaceExtractor.h"
+#include "meshBatcher.h"
+#include "pivotCalibration.h"
+#include "planeMeshSlicer.h"
+#include "renderScene.h"
+#include "threadPool.h"
+#include "toolTrail.h"
+#include "trackingStatistics.h"
+#include "treEstimator.h"
+#include "usReconstructor.h"
+
 // C++ includes
+#include <memory>
 #include <tuple>
 #include <vector>
 
 // Qt includes
+#include <QImage>
+#include <QPoint>
 #include <qstring.h>
 
 // VTK forward declaration
 class vtkActor;
 class vtkGenericOpenGLRenderWindow;
 class vtkImageCanvasSource2D;
+class vtkImageData;
 class vtkLogoRepresentation;
 class vtkLogoWidget; 
+class vtkMatrix4x4;
 class vtkNDITracker;
 class vtkPoints;
+class vtkPolyData;
 class vtkRenderer;
+class vtkTextActor;
+class vtkTracker;
 class vtkTrackerTool;
 class vtkVolume;
 
+class QLabel;
+class QListWidgetItem;
 class QTimer;
+class renderThread;
 
 //! an enum type to specify the type of tracked objects
 enum enumTrackedObjectTypes {
@@ -104,6 +127,9 @@ public slots:
   virtual void slotExit();
 
   void loadMesh();
+  void loadStructures();
+  void structureItemChanged(QListWidgetItem *item);
+  void editStructureColor(QListWidgetItem *item);
   void loadVolume();
   void loadFiducialPts();
   void editMeshColor();
@@ -116,6 +142,22 @@ public slots:
   void resetPhantomCollectedPoints();
   void deleteOnePhantomCollectedPoints();
   void performPhantomRegistration();
+  void startUSReconstructionFromFile();
+  void startUSReconstructionSynthetic();
+  void stopUSReconstruction();
+  void updateUSReconstruction();
+  void threadedRendering(bool);
+  void showRenderedFrame();
+  void isoSurfaceMode(bool);
+  void isoSurfaceThresholdChanged(int);
+  void showIsoSurface();
+  void exportTrackingStatistics();
+  void binaryAcquisition(bool);
+  void stylusTrailMode(bool);
+  void stylusTrailLast30Seconds(bool);
+  void clearStylusTrail();
+  void traceRecording(bool);
+  void exportTrace();
 
   void aboutThisProgram();
 
@@ -132,34 +174,118 @@ public:
   // clean up
   void cleanVTKObjects();
 
+  //! render the scene, on the render thread if it is running
+  void render();
+
+protected:
+  //! camera interaction with the render thread view
+  bool eventFilter(QObject *obj, QEvent *event) override;
+
 private:
   void createTrackerLogo();
   void createLinearZStylusActor();
+  void updateLaserContour(int toolIdx);
+  void estimateTRE(double fre);
+  void updateStructureActors();
+  void updateToolStatisticsText();
+  QString trackedObjectName(int idx) const;
+  void startUSReconstruction(std::unique_ptr<usFrameSource> source, bool useTrackedProbe);
+
+  //! index into trackedObjects/tools of the first object of the given type, -1 if none
+  int findTrackedObject(enumTrackedObjectTypes type) const;
 
 private:
   // QT Objects
   QTimer                                              *trackerTimer;
+  QTimer                                              *usReconTimer;
+  QLabel                                              *renderView;
 
   // VTK Objects
   vtkSmartPointer<vtkActor>                           actor;
+  vtkSmartPointer<vtkActor>                           laserContourActor;
   vtkSmartPointer<vtkActor>                           stylusActor;
   vtkSmartPointer<vtkGenericOpenGLRenderWindow>       renWin;
   vtkSmartPointer<vtkImageCanvasSource2D>             trackerDrawing;
   vtkSmartPointer<vtkLogoRepresentation>              trackerLogoRepresentation;
   vtkSmartPointer<vtkLogoWidget>                      trackerLogoWidget;
   vtkSmartPointer<vtkRenderer>                        ren;
+  vtkSmartPointer<vtkTextActor>                       toolStatisticsText;
   vtkSmartPointer<vtkPoints>                          fiducialPts;
+  vtkSmartPointer<vtkPoints>                          collectedPts;
+  vtkSmartPointer<vtkMatrix4x4>                       registrationMatrix;
+  vtkSmartPointer<vtkImageData>                       volumeData;
+  vtkSmartPointer<vtkPolyData>                        meshData;
+  vtkSmartPointer<vtkPolyData>                        laserContour;
   vtkSmartPointer<vtkVolume>                          volume;
+  vtkSmartPointer<vtkImageData>                       usVolume;
 
   /*!
   * Tracker related objects.
   */
-  vtkSmartPointer< vtkNDITracker >                    myTracker;
+  vtkSmartPointer< vtkTracker >                       myTracker;   // vtkNDITracker, or vtkNDIBinaryTracker
+  QString                                             ndiSerialDevice;
   std::vector< trackedObjectTypes >                   trackedObjects;
   std::vector< vtkTrackerTool * >                     tools;
+  pivotCalibration                                    stylusPivot;
+  std::vector< toolStatistics >                       toolStats;
+  std::vector< double >                               toolLastTimeStamp;
+  double                                              toolStatisticsTextTime;
+
+  /*!
+  * Path of the stylus tip, in tracker coordinates, one actor per trail chunk.
+  */
+  toolTrail                                           stylusTrail;
+  std::vector< vtkSmartPointer<vtkActor> >            stylusTrailActors;
+
+  /*!
+  * One thread per core, shared by the parallel computations below. Declared
+  * first, so that it outlives them.
+  */
+  threadPool                                          workerPool;
+
+  /*!
+  * Freehand ultrasound reconstruction.
+  */
+  std::unique_ptr<usReconstructor>                    usRecon;
+  bool                                                usUsesTrackedProbe;
+
+  /*!
+  * Laser plane / mesh intersection, indexed lazily after each loadMesh().
+  */
+  planeMeshSlicer                                     laserSlicer;
+  bool                                                isLaserSlicerOutdated;
+  double                                              laserStatusTime;
+
+  /*!
+  * Segmented structures, merged into one actor per material.
+  */
+  meshBatcher                                         structures;
+  std::vector< vtkSmartPointer<vtkActor> >            structureActors;
+
+  /*!
+  * Iso-surface of volumeData, extracted off the GUI thread.
+  */
+  isoSurfaceExtractor                                 isoSurface;
+  double                                              isoScalarRange[2];
+
+  /*!
+  * Target registration error, estimated after each phantom registration.
+  */
+  treEstimator                                        treEstimate;
+
+  /*!
+  * Threaded rendering: the scene is snapshot after every change and drawn
+  * by sceneRenderer into renderView.
+  */
+  renderThread                                        *sceneRenderer;
+  renderSceneCapture                                  sceneCapture;
+  renderSceneState                                    sceneState;
+  QImage                                              lastRenderedFrame;
+  QPoint                                              lastMousePos;
 
   int                                                 screenShotFileNumber;
   bool                                                isTrackerInitialized, isStylusCalibrated;
+  bool                                                isCollectingPivot;
   int                                                 numTrackedTools;
   int                                                 logoWidgetX, logoWidgetY;
 };
@@ -0,0 +1,283 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: meshBatcher.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "meshBatcher.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkUnsignedCharArray.h>
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+
+namespace
+{
+void toRGB(const double color[3], unsigned char rgb[3])
+{
+  for (int j = 0; j < 3; j++)
+    rgb[j] = (unsigned char)std::lround(255.0 * std::min(1.0, std::max(0.0, color[j])));
+}
+} // namespace
+
+
+meshBatcher::meshBatcher()
+{
+  mergeMs = 0.0;
+  updateMs = 0.0;
+}
+
+
+void meshBatcher::clear()
+{
+  structures.clear();
+  batches.clear();
+  mergeMs = 0.0;
+  updateMs = 0.0;
+}
+
+
+int meshBatcher::findBatch(const meshMaterial &material)
+{
+  for (int b = 0; b < (int)batches.size(); b++)
+    if (batches[b].material == material)
+      return b;
+
+  batch bt;
+  bt.material = material;
+  bt.cellsOutdated = false;
+  bt.data = vtkSmartPointer<vtkPolyData>::New();
+
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToFloat();
+  bt.data->SetPoints(points);
+
+  vtkNew<vtkFloatArray> normals;
+  normals->SetName("Normals");
+  normals->SetNumberOfComponents(3);
+  bt.data->GetPointData()->SetNormals(normals);
+
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetName("Colors");
+  colors->SetNumberOfComponents(3);
+  bt.data->GetPointData()->SetScalars(colors);
+
+  vtkNew<vtkCellArray> polys;
+  bt.data->SetPolys(polys);
+
+  batches.push_back(bt);
+  return (int)batches.size() - 1;
+}
+
+
+int meshBatcher::addStructure(const std::string &name, vtkPolyData *mesh, const double color[3],
+  const meshMaterial &material)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  int b = this->findBatch(material);
+  batch &bt = batches[b];
+  vtkPoints *points = bt.data->GetPoints();
+  vtkDataArray *normals = bt.data->GetPointData()->GetNormals();
+  vtkUnsignedCharArray *colors = vtkUnsignedCharArray::SafeDownCast(bt.data->GetPointData()->GetScalars());
+
+  structure s;
+  s.name = name;
+  s.batch = b;
+  s.firstPoint = points->GetNumberOfPoints();
+  s.numPoints = 0;
+  s.firstConnectivity = bt.connectivity.size();
+  s.numCells = 0;
+  std::copy(color, color + 3, s.color);
+  s.visible = true;
+
+  if (mesh && mesh->GetNumberOfPoints() > 0 && mesh->GetNumberOfPolys() + mesh->GetNumberOfStrips() > 0)
+    {
+    // the batch is lit as a whole, so every structure brings its point normals
+    vtkNew<vtkPolyDataNormals> normalFilter;
+    normalFilter->SetInputData(mesh);
+    normalFilter->SplittingOff();
+    normalFilter->ComputePointNormalsOn();
+    normalFilter->ComputeCellNormalsOff();
+    normalFilter->Update();
+    vtkPolyData *in = normalFilter->GetOutput();
+    vtkDataArray *inNormals = in->GetPointData()->GetNormals();
+
+    unsigned char rgb[3];
+    toRGB(color, rgb);
+    s.numPoints = in->GetNumberOfPoints();
+    for (vtkIdType i = 0; i < s.numPoints; i++)
+      {
+      points->InsertNextPoint(in->GetPoint(i));
+      normals->InsertNextTuple(inNormals->GetTuple(i));
+      colors->InsertNextTypedTuple(rgb);
+      }
+
+    vtkIdType npts, *pts;
+    vtkCellArray *polys = in->GetPolys();
+    for (polys->InitTraversal(); polys->GetNextCell(npts, pts); )
+      {
+      bt.connectivity.push_back(npts);
+      for (vtkIdType k = 0; k < npts; k++)
+        bt.connectivity.push_back(s.firstPoint + pts[k]);
+      s.numCells++;
+      }
+
+    points->Modified();
+    normals->Modified();
+    colors->Modified();
+    }
+  s.connectivityLength = bt.connectivity.size() - s.firstConnectivity;
+
+  bt.structures.push_back((int)structures.size());
+  bt.cellsOutdated = true;
+  structures.push_back(s);
+
+  mergeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+  return (int)structures.size() - 1;
+}
+
+
+void meshBatcher::setColor(int idx, const double color[3])
+{
+  structure &s = structures[idx];
+  std::copy(color, color + 3, s.color);
+
+  // rewrite the colours in place, only over the points of the structure
+  unsigned char rgb[3];
+  toRGB(color, rgb);
+  vtkUnsignedCharArray *colors =
+    vtkUnsignedCharArray::SafeDownCast(batches[s.batch].data->GetPointData()->GetScalars());
+  for (vtkIdType i = s.firstPoint; i < s.firstPoint + s.numPoints; i++)
+    colors->SetTypedTuple(i, rgb);
+  colors->Modified();
+}
+
+
+void meshBatcher::getColor(int idx, double color[3]) const
+{
+  std::copy(structures[idx].color, structures[idx].color + 3, color);
+}
+
+
+void meshBatcher::setVisibility(int idx, bool visible)
+{
+  structure &s = structures[idx];
+  if (s.visible == visible)
+    return;
+  s.visible = visible;
+  batches[s.batch].cellsOutdated = true;
+}
+
+
+void meshBatcher::update()
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  for (batch &bt : batches)
+    {
+    if (!bt.cellsOutdated)
+      continue;
+
+    // concatenate the cells of the visible structures
+    size_t length = 0;
+    vtkIdType numCells = 0;
+    for (int idx : bt.structures)
+      {
+      if (structures[idx].visible)
+        {
+        length += structures[idx].connectivityLength;
+        numCells += structures[idx].numCells;
+        }
+      }
+
+    vtkNew<vtkIdTypeArray> ids;
+    ids->SetNumberOfValues((vtkIdType)length);
+    vtkIdType *dst = ids->GetPointer(0);
+    for (int idx : bt.structures)
+      {
+      const structure &s = structures[idx];
+      if (s.visible)
+        {
+        std::copy(bt.connectivity.begin() + s.firstConnectivity,
+          bt.connectivity.begin() + s.firstConnectivity + s.connectivityLength, dst);
+        dst += s.connectivityLength;
+        }
+      }
+
+    vtkNew<vtkCellArray> polys;
+    polys->SetCells(numCells, ids);
+    bt.data->SetPolys(polys);
+    bt.cellsOutdated = false;
+    }
+
+  updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+meshBatcher::statistics meshBatcher::getStatistics() const
+{
+  statistics stats;
+  stats.numStructures = (int)structures.size();
+  stats.numBatches = (int)batches.size();
+  for (const batch &bt : batches)
+    {
+    stats.numPoints += bt.data->GetNumberOfPoints();
+    stats.numVisibleCells += bt.data->GetNumberOfPolys();
+    }
+  stats.mergeMs = mergeMs;
+  stats.updateMs = updateMs;
+  return stats;
+}
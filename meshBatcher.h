@@ -0,0 +1,160 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: meshBatcher.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __MESHBATCHER_H__
+#define __MESHBATCHER_H__
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+// C++ includes
+#include <string>
+#include <vector>
+
+// VTK forward declaration
+class vtkPolyData;
+
+//! rendering properties shared by all structures of a batch
+struct meshMaterial
+  {
+  double opacity = 1.0;
+  double specular = 0.0;
+
+  bool operator==(const meshMaterial &other) const
+    {
+    return opacity == other.opacity && specular == other.specular;
+    }
+  };
+
+/*!
+* Many static meshes (e.g. segmented anatomical structures) drawn with a few
+* actors: structures sharing a material are merged into one polydata, a batch,
+* so the number of draw calls and culled props follows the number of materials
+* rather than the number of structures.
+*
+* Each structure keeps its own colour, stored as RGB point scalars over its
+* range of the batch points, and its own visibility: hiding a structure drops
+* its polygons from the batch cells, the points stay in place. Changes are
+* applied to the batches by update(), which only touches the batches that
+* changed. Polygons are kept, and so are triangle strips, which the normals
+* computation turns into triangles; lines and vertices are ignored.
+*/
+class meshBatcher
+{
+public:
+  struct statistics
+    {
+    int       numStructures = 0;
+    int       numBatches = 0;
+    long long numPoints = 0;
+    long long numVisibleCells = 0;
+    double    mergeMs = 0.0;    // total time spent in addStructure()
+    double    updateMs = 0.0;   // last update()
+    };
+
+  meshBatcher();
+
+  //! remove all structures and batches
+  void clear();
+
+  /*!
+  * Append mesh to the batch of its material, creating the batch if needed.
+  * The geometry is copied (as float points with point normals). Returns the
+  * index of the structure.
+  */
+  int addStructure(const std::string &name, vtkPolyData *mesh, const double color[3],
+    const meshMaterial &material = meshMaterial());
+
+  int getNumberOfStructures() const { return (int)structures.size(); }
+  const std::string &getName(int idx) const { return structures[idx].name; }
+  int getBatchOfStructure(int idx) const { return structures[idx].batch; }
+
+  void setColor(int idx, const double color[3]);
+  void getColor(int idx, double color[3]) const;
+
+  void setVisibility(int idx, bool visible);
+  bool getVisibility(int idx) const { return structures[idx].visible; }
+
+  //! rebuild the cells of the batches whose visibility changed since the last update()
+  void update();
+
+  int getNumberOfBatches() const { return (int)batches.size(); }
+  vtkPolyData *getBatch(int b) const { return batches[b].data; }
+  const meshMaterial &getBatchMaterial(int b) const { return batches[b].material; }
+
+  statistics getStatistics() const;
+
+private:
+  struct structure
+    {
+    std::string name;
+    int         batch;
+    vtkIdType   firstPoint, numPoints;
+    size_t      firstConnectivity, connectivityLength;  // range in batch::connectivity
+    vtkIdType   numCells;
+    double      color[3];
+    bool        visible;
+    };
+
+  struct batch
+    {
+    meshMaterial                  material;
+    vtkSmartPointer<vtkPolyData>  data;
+    std::vector<vtkIdType>        connectivity;  // all cells, (n, id0, ..., idn-1) each
+    std::vector<int>              structures;
+    bool                          cellsOutdated;
+    };
+
+  int findBatch(const meshMaterial &material);
+
+  std::vector<structure>  structures;
+  std::vector<batch>      batches;
+  double                  mergeMs;
+  double                  updateMs;
+};
+
+#endif // of __MESHBATCHER_H__
@@ -0,0 +1,296 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiBinaryClient.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "ndiBinaryClient.h"
+#include "traceRecorder.h"
+
+// C++ includes
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+
+namespace
+{
+// the systems need this long after a break or a COMM before the next command
+const int settleMs = 100;
+
+std::string hex(unsigned int value, int digits)
+{
+  char buf[16];
+  std::snprintf(buf, sizeof(buf), "%0*X", digits, value);
+  return buf;
+}
+} // namespace
+
+
+bool ndiBinaryClient::fail(const std::string &error)
+{
+  lastError = error;
+  return false;
+}
+
+
+bool ndiBinaryClient::open(const std::string &device)
+{
+  stats = statistics();
+  lastError.clear();
+  if (!link.open(device))
+    return this->fail("cannot open " + device);
+  stats.baudRate = link.getBaudRate();
+  return true;
+}
+
+
+void ndiBinaryClient::close()
+{
+  link.close();
+}
+
+
+bool ndiBinaryClient::command(const std::string &name, const std::string &params, std::string &reply,
+  int timeoutMs)
+{
+  if (!link.write(ndiFormatCommand(name, params)))
+    return this->fail(name + ": write failed");
+
+  std::string line;
+  if (!link.readLine(line, timeoutMs))
+    return this->fail(name + ": no reply");
+  if (!ndiCheckReply(line, reply))
+    return this->fail(name + ": CRC error");
+  if (reply.compare(0, 5, "ERROR") == 0)
+    return this->fail(name + ": " + reply);
+  return true;
+}
+
+
+bool ndiBinaryClient::initialize()
+{
+  std::string reply;
+  if (this->command("INIT", "", reply))
+    return true;
+
+  // the system may still be at the rate of a previous session
+  link.sendBreak();
+  link.setBaudRate(9600);
+  std::this_thread::sleep_for(std::chrono::milliseconds(settleMs));
+  link.discardInput();
+  stats.baudRate = link.getBaudRate();
+  return this->command("INIT", "", reply);
+}
+
+
+int ndiBinaryClient::negotiateBaudRate(int maxBaud)
+{
+  std::string reply;
+  for (const ndiBaudRate &rate : ndiBaudRates())
+    {
+    if (rate.baud > maxBaud)
+      continue;
+    if (rate.baud == link.getBaudRate())
+      break;
+
+    // the host must be able to follow before the system is asked to switch
+    int previous = link.getBaudRate();
+    if (!link.setBaudRate(rate.baud) || !link.setBaudRate(previous))
+      continue;
+
+    // 8 data bits, no parity, 1 stop bit, no handshake
+    if (!this->command("COMM", std::string(1, rate.code) + "0000", reply))
+      continue;
+    link.setBaudRate(rate.baud);
+    std::this_thread::sleep_for(std::chrono::milliseconds(settleMs));
+    link.discardInput();
+    if (this->command("VER", "4", reply))
+      break;
+
+    // the system did not come back at the new rate: reset it to 9600 and go on lower
+    link.sendBreak();
+    link.setBaudRate(9600);
+    std::this_thread::sleep_for(std::chrono::milliseconds(settleMs));
+    link.discardInput();
+    if (!this->command("INIT", "", reply))
+      return 0;
+    }
+
+  stats.baudRate = link.getBaudRate();
+  lastError.clear();
+  return stats.baudRate;
+}
+
+
+int ndiBinaryClient::addVirtualTool(const std::vector<unsigned char> &srom)
+{
+  // any wireless (passive) tool
+  std::string reply;
+  if (!this->command("PHRQ", "*********1****", reply) || reply.size() < 2)
+    return -1;
+  std::string handle = reply.substr(0, 2);
+
+  // the tool definition, 64 bytes per PVWR, zero padded
+  for (size_t address = 0; address < srom.size(); address += 64)
+    {
+    std::string params = handle + hex((unsigned int)address, 4);
+    for (size_t k = address; k < address + 64; k++)
+      params += hex(k < srom.size() ? srom[k] : 0, 2);
+    if (!this->command("PVWR", params, reply))
+      return -1;
+    }
+
+  if (!this->command("PINIT", handle, reply) || !this->command("PENA", handle + "D", reply))
+    return -1;
+
+  unsigned int value;
+  if (std::sscanf(handle.c_str(), "%2X", &value) != 1)
+    return -1;
+  return (int)value;
+}
+
+
+bool ndiBinaryClient::startTracking()
+{
+  std::string reply;
+  return this->command("TSTART", "", reply);
+}
+
+
+bool ndiBinaryClient::stopTracking()
+{
+  std::string reply;
+  return this->command("TSTOP", "", reply);
+}
+
+
+bool ndiBinaryClient::getTransforms(ndiTransformReply &reply)
+{
+  AIGS_TRACE_SCOPE("ndiBinaryClient::getTransforms");
+  auto t0 = std::chrono::steady_clock::now();
+  if (!link.write(ndiFormatCommand("BX", "0001")))
+    return this->fail("BX: write failed");
+
+  if (!link.waitForBytes(1, defaultTimeoutMs))
+    return this->fail("BX: no reply");
+
+  // errors come back as ASCII replies
+  if (link.data()[0] != (ndiBinaryStart & 0xFF))
+    {
+    std::string line, body;
+    if (link.readLine(line, defaultTimeoutMs) && ndiCheckReply(line, body))
+      return this->fail("BX: " + body);
+    return this->fail("BX: unexpected reply");
+    }
+
+  if (!link.waitForBytes(ndiBinaryHeaderSize, defaultTimeoutMs))
+    return this->fail("BX: incomplete reply");
+  size_t total = ndiBinaryHeaderSize + (link.data()[2] | (link.data()[3] << 8)) + 2;
+  if (!link.waitForBytes(total, defaultTimeoutMs))
+    return this->fail("BX: incomplete reply");
+
+  auto t1 = std::chrono::steady_clock::now();
+  long used = ndiParseBX(link.data(), link.available(), reply);
+  auto t2 = std::chrono::steady_clock::now();
+  if (used <= 0)
+    {
+    link.discardInput();
+    return this->fail("BX: malformed reply");
+    }
+  link.consume(used);
+
+  this->addReplyTime(std::chrono::duration<double, std::milli>(t2 - t0).count(),
+    std::chrono::duration<double, std::micro>(t2 - t1).count());
+  return true;
+}
+
+
+bool ndiBinaryClient::getTransformsASCII(ndiTransformReply &reply)
+{
+  AIGS_TRACE_SCOPE("ndiBinaryClient::getTransformsASCII");
+  auto t0 = std::chrono::steady_clock::now();
+  std::string body;
+  if (!this->command("TX", "0001", body))
+    return false;
+
+  auto t1 = std::chrono::steady_clock::now();
+  bool ok = ndiParseTX(body, reply);
+  auto t2 = std::chrono::steady_clock::now();
+  if (!ok)
+    return this->fail("TX: malformed reply");
+
+  this->addReplyTime(std::chrono::duration<double, std::milli>(t2 - t0).count(),
+    std::chrono::duration<double, std::micro>(t2 - t1).count());
+  return true;
+}
+
+
+void ndiBinaryClient::addReplyTime(double ms, double parseUs)
+{
+  stats.replies++;
+  stats.lastReplyMs = ms;
+  stats.meanReplyMs += (ms - stats.meanReplyMs) / stats.replies;
+  stats.lastParseUs = parseUs;
+}
+
+
+ndiBinaryClient::statistics ndiBinaryClient::getStatistics() const
+{
+  statistics s = stats;
+  s.bytesRead = link.getBytesRead();
+  s.bytesWritten = link.getBytesWritten();
+  return s;
+}
+
+
+bool ndiBinaryClient::readSROMFile(const std::string &fname, std::vector<unsigned char> &srom)
+{
+  std::ifstream is(fname.c_str(), std::ios::binary);
+  if (!is)
+    return false;
+  srom.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+  return !srom.empty();
+}
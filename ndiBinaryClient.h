@@ -0,0 +1,134 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiBinaryClient.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __NDIBINARYCLIENT_H__
+#define __NDIBINARYCLIENT_H__
+
+#pragma once
+
+// local includes
+#include "ndiProtocol.h"
+#include "ndiSerialLink.h"
+
+// C++ includes
+#include <string>
+#include <vector>
+
+/*!
+* Client of an NDI tracking system over a serial line, for high-rate
+* acquisition: the link is moved to the highest baud rate both the host and the
+* system accept, and transformations are read with BX, whose binary replies are
+* about half the size of TX replies and need no text parsing.
+*
+* Typical session: open(), initialize(), negotiateBaudRate(), addVirtualTool()
+* per tool, startTracking(), then getTransforms() once per frame.
+*/
+class ndiBinaryClient
+{
+public:
+  struct statistics
+    {
+    int       baudRate = 0;
+    long long replies = 0;           // transformation replies
+    long long bytesRead = 0;
+    long long bytesWritten = 0;
+    double    lastReplyMs = 0.0;     // command sent to reply parsed
+    double    meanReplyMs = 0.0;
+    double    lastParseUs = 0.0;
+    };
+
+  static const int defaultTimeoutMs = 1000;
+
+  bool open(const std::string &device);
+  void close();
+  bool isOpen() const { return link.isOpen(); }
+
+  //! INIT; if the system does not answer, reset it with a serial break and retry
+  bool initialize();
+
+  /*!
+  * Switch the link to the highest rate, not above maxBaud, that the host can
+  * set and the system accepts. POSIX hosts only set standard termios rates, so
+  * there 1228739 is skipped and 921600 is the ceiling. Each candidate is checked
+  * with a VER round trip; a failed switch is undone with a serial break.
+  * Returns the rate, 0 on error.
+  */
+  int negotiateBaudRate(int maxBaud = 1228739);
+
+  /*!
+  * Send a command and read its ASCII reply, without CRC. Returns false on
+  * timeout, on a CRC mismatch, or if the system replies with an error.
+  */
+  bool command(const std::string &name, const std::string &params, std::string &reply,
+    int timeoutMs = defaultTimeoutMs);
+
+  //! request a wireless port handle, write the tool definition and enable it. Returns the handle, -1 on error.
+  int addVirtualTool(const std::vector<unsigned char> &srom);
+
+  bool startTracking();
+  bool stopTracking();
+
+  //! transformations of all enabled handles with BX (binary reply)
+  bool getTransforms(ndiTransformReply &reply);
+
+  //! the same with TX (ASCII reply), for comparison
+  bool getTransformsASCII(ndiTransformReply &reply);
+
+  const std::string &getLastError() const { return lastError; }
+  statistics getStatistics() const;
+
+  //! read a tool definition (.rom) file
+  static bool readSROMFile(const std::string &fname, std::vector<unsigned char> &srom);
+
+private:
+  bool fail(const std::string &error);
+  void addReplyTime(double ms, double parseUs);
+
+  ndiSerialLink link;
+  std::string   lastError;
+  statistics    stats;
+};
+
+#endif // of __NDIBINARYCLIENT_H__
@@ -0,0 +1,518 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiProtocol.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "ndiProtocol.h"
+
+// C++ includes
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace
+{
+struct crcTable
+  {
+  unsigned int values[256];
+
+  crcTable()
+    {
+    for (unsigned int i = 0; i < 256; i++)
+      {
+      unsigned int crc = i;
+      for (int k = 0; k < 8; k++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+      values[i] = crc;
+      }
+    }
+  };
+
+const crcTable table;
+
+
+// little-endian fields of binary replies
+unsigned int getUInt16(const unsigned char *p)
+{
+  return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+
+unsigned int getUInt32(const unsigned char *p)
+{
+  return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+
+float getFloat32(const unsigned char *p)
+{
+  unsigned int u = getUInt32(p);
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+
+void putUInt16(std::vector<unsigned char> &out, unsigned int v)
+{
+  out.push_back((unsigned char)(v & 0xFF));
+  out.push_back((unsigned char)((v >> 8) & 0xFF));
+}
+
+
+void putUInt32(std::vector<unsigned char> &out, unsigned int v)
+{
+  for (int k = 0; k < 4; k++)
+    out.push_back((unsigned char)((v >> (8 * k)) & 0xFF));
+}
+
+
+void putFloat32(std::vector<unsigned char> &out, double v)
+{
+  float f = (float)v;
+  unsigned int u;
+  std::memcpy(&u, &f, sizeof(u));
+  putUInt32(out, u);
+}
+
+
+// value of n hex digits, false if any is not a hex digit
+bool hexValue(const char *s, int n, unsigned int &value)
+{
+  value = 0;
+  for (int k = 0; k < n; k++)
+    {
+    char c = s[k];
+    unsigned int d;
+    if (c >= '0' && c <= '9')
+      d = c - '0';
+    else if (c >= 'A' && c <= 'F')
+      d = c - 'A' + 10;
+    else if (c >= 'a' && c <= 'f')
+      d = c - 'a' + 10;
+    else
+      return false;
+    value = (value << 4) | d;
+    }
+  return true;
+}
+
+
+// signed fixed-point field of TX replies: sign and n - 1 digits, scaled by 10^-decimals
+bool fixedValue(const char *s, int n, int decimals, double &value)
+{
+  if (s[0] != '+' && s[0] != '-')
+    return false;
+  long v = 0;
+  for (int k = 1; k < n; k++)
+    {
+    if (s[k] < '0' || s[k] > '9')
+      return false;
+    v = 10 * v + (s[k] - '0');
+    }
+  static const double scale[] = { 1.0, 0.1, 0.01, 0.001, 0.0001 };
+  value = (s[0] == '-' ? -v : v) * scale[decimals];
+  return true;
+}
+
+
+void appendFixed(std::string &s, double value, int n, int decimals)
+{
+  long limit = 1;
+  for (int k = 1; k < n; k++)
+    limit *= 10;
+  long v = std::lround(std::fabs(value) * std::pow(10.0, decimals));
+  if (v >= limit)
+    v = limit - 1;
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%c%0*ld", value < 0.0 ? '-' : '+', n - 1, v);
+  s += buf;
+}
+
+
+void appendHex(std::string &s, unsigned int value, int n)
+{
+  char buf[16];
+  std::snprintf(buf, sizeof(buf), "%0*X", n, value);
+  s += buf;
+}
+} // namespace
+
+
+unsigned int ndiCRC16(const unsigned char *data, size_t n, unsigned int crc)
+{
+  for (size_t i = 0; i < n; i++)
+    crc = (crc >> 8) ^ table.values[(crc ^ data[i]) & 0xFF];
+  return crc;
+}
+
+
+unsigned int ndiCRC16(const std::string &s)
+{
+  return ndiCRC16((const unsigned char *)s.data(), s.size());
+}
+
+
+const std::vector<ndiBaudRate> &ndiBaudRates()
+{
+  static const std::vector<ndiBaudRate> rates = {
+    { 1228739, '7' }, { 921600, '6' }, { 230400, 'A' }, { 115200, '5' },
+    { 57600, '4' }, { 38400, '3' }, { 19200, '2' }, { 14400, '1' }, { 9600, '0' } };
+  return rates;
+}
+
+
+char ndiBaudCode(int baud)
+{
+  for (const ndiBaudRate &r : ndiBaudRates())
+    if (r.baud == baud)
+      return r.code;
+  return 0;
+}
+
+
+int ndiBaudFromCode(char code)
+{
+  for (const ndiBaudRate &r : ndiBaudRates())
+    if (r.code == code)
+      return r.baud;
+  return 0;
+}
+
+
+std::string ndiFormatCommand(const std::string &name, const std::string &params)
+{
+  std::string cmd = name + ":" + params;
+  appendHex(cmd, ndiCRC16(cmd), 4);
+  cmd += '\r';
+  return cmd;
+}
+
+
+bool ndiParseCommand(const std::string &line, std::string &name, std::string &params)
+{
+  size_t sep = line.find_first_of(" :");
+  if (sep == std::string::npos)
+    {
+    name = line;
+    params.clear();
+    return !name.empty();
+    }
+
+  name = line.substr(0, sep);
+  if (line[sep] == ' ')
+    {
+    params = line.substr(sep + 1);
+    return true;
+    }
+
+  // with CRC: the last 4 characters are the CRC of everything before them
+  if (line.size() < sep + 5)
+    return false;
+  unsigned int crc;
+  if (!hexValue(line.data() + line.size() - 4, 4, crc))
+    return false;
+  if (crc != ndiCRC16((const unsigned char *)line.data(), line.size() - 4))
+    return false;
+  params = line.substr(sep + 1, line.size() - 4 - sep - 1);
+  return true;
+}
+
+
+std::string ndiFormatReply(const std::string &body)
+{
+  std::string reply = body;
+  appendHex(reply, ndiCRC16(body), 4);
+  reply += '\r';
+  return reply;
+}
+
+
+bool ndiCheckReply(const std::string &reply, std::string &body)
+{
+  if (reply.size() < 4)
+    return false;
+  unsigned int crc;
+  if (!hexValue(reply.data() + reply.size() - 4, 4, crc))
+    return false;
+  if (crc != ndiCRC16((const unsigned char *)reply.data(), reply.size() - 4))
+    return false;
+  body = reply.substr(0, reply.size() - 4);
+  return true;
+}
+
+
+long ndiParseBX(const unsigned char *data, size_t n, ndiTransformReply &reply)
+{
+  if (n < ndiBinaryHeaderSize)
+    return 0;
+  if (getUInt16(data) != ndiBinaryStart || getUInt16(data + 4) != ndiCRC16(data, 4))
+    return -1;
+
+  size_t length = getUInt16(data + 2);
+  size_t total = ndiBinaryHeaderSize + length + 2;
+  if (n < total)
+    return 0;
+
+  const unsigned char *body = data + ndiBinaryHeaderSize;
+  if (getUInt16(body + length) != ndiCRC16(body, length))
+    return -1;
+
+  // the body: handles, then the system status
+  const unsigned char *p = body, *end = body + length;
+  if (p + 1 > end)
+    return -1;
+  int numHandles = *p++;
+  reply.handles.resize(numHandles);
+  for (int h = 0; h < numHandles; h++)
+    {
+    ndiHandleTransform &t = reply.handles[h];
+    t = ndiHandleTransform();
+    if (p + 2 > end)
+      return -1;
+    t.handle = p[0];
+    t.status = p[1];
+    p += 2;
+
+    if (t.status == enHandleDisabled)
+      continue;
+    if (t.status == enHandleValid)
+      {
+      if (p + 32 > end)
+        return -1;
+      for (int k = 0; k < 4; k++)
+        t.q[k] = getFloat32(p + 4 * k);
+      for (int k = 0; k < 3; k++)
+        t.t[k] = getFloat32(p + 16 + 4 * k);
+      t.error = getFloat32(p + 28);
+      p += 32;
+      }
+    if (p + 8 > end)
+      return -1;
+    t.portStatus = getUInt32(p);
+    t.frame = getUInt32(p + 4);
+    p += 8;
+    }
+  if (p + 2 != end)
+    return -1;
+  reply.systemStatus = getUInt16(p);
+
+  return (long)total;
+}
+
+
+bool ndiParseTX(const std::string &body, ndiTransformReply &reply)
+{
+  const char *p = body.c_str(), *end = p + body.size();
+  unsigned int numHandles;
+  if (end - p < 2 || !hexValue(p, 2, numHandles))
+    return false;
+  p += 2;
+
+  reply.handles.resize(numHandles);
+  for (unsigned int h = 0; h < numHandles; h++)
+    {
+    ndiHandleTransform &t = reply.handles[h];
+    t = ndiHandleTransform();
+    unsigned int handle;
+    if (end - p < 2 || !hexValue(p, 2, handle))
+      return false;
+    t.handle = (int)handle;
+    p += 2;
+
+    if (end - p >= 8 && std::strncmp(p, "DISABLED", 8) == 0)
+      {
+      t.status = enHandleDisabled;
+      p += 8;
+      }
+    else
+      {
+      if (end - p >= 7 && std::strncmp(p, "MISSING", 7) == 0)
+        {
+        t.status = enHandleMissing;
+        p += 7;
+        }
+      else
+        {
+        // 4 x 6 quaternion, 3 x 7 translation, 6 error
+        if (end - p < 51)
+          return false;
+        t.status = enHandleValid;
+        for (int k = 0; k < 4; k++, p += 6)
+          if (!fixedValue(p, 6, 4, t.q[k]))
+            return false;
+        for (int k = 0; k < 3; k++, p += 7)
+          if (!fixedValue(p, 7, 2, t.t[k]))
+            return false;
+        if (!fixedValue(p, 6, 4, t.error))
+          return false;
+        p += 6;
+        }
+
+      unsigned int portStatus, frame;
+      if (end - p < 16 || !hexValue(p, 8, portStatus) || !hexValue(p + 8, 8, frame))
+        return false;
+      t.portStatus = portStatus;
+      t.frame = frame;
+      p += 16;
+      }
+
+    if (p >= end || *p != '\n')
+      return false;
+    p++;
+    }
+
+  unsigned int systemStatus;
+  if (end - p != 4 || !hexValue(p, 4, systemStatus))
+    return false;
+  reply.systemStatus = systemStatus;
+  return true;
+}
+
+
+void ndiEncodeBX(const ndiTransformReply &reply, std::vector<unsigned char> &out)
+{
+  size_t start = out.size();
+  putUInt16(out, ndiBinaryStart);
+  putUInt16(out, 0); // body length, filled in below
+  putUInt16(out, 0); // header CRC
+
+  size_t bodyStart = out.size();
+  out.push_back((unsigned char)reply.handles.size());
+  for (const ndiHandleTransform &t : reply.handles)
+    {
+    out.push_back((unsigned char)t.handle);
+    out.push_back((unsigned char)t.status);
+    if (t.status == enHandleDisabled)
+      continue;
+    if (t.status == enHandleValid)
+      {
+      for (int k = 0; k < 4; k++)
+        putFloat32(out, t.q[k]);
+      for (int k = 0; k < 3; k++)
+        putFloat32(out, t.t[k]);
+      putFloat32(out, t.error);
+      }
+    putUInt32(out, t.portStatus);
+    putUInt32(out, t.frame);
+    }
+  putUInt16(out, reply.systemStatus);
+
+  size_t length = out.size() - bodyStart;
+  out[start + 2] = (unsigned char)(length & 0xFF);
+  out[start + 3] = (unsigned char)((length >> 8) & 0xFF);
+  unsigned int headerCRC = ndiCRC16(&out[start], 4);
+  out[start + 4] = (unsigned char)(headerCRC & 0xFF);
+  out[start + 5] = (unsigned char)((headerCRC >> 8) & 0xFF);
+  putUInt16(out, ndiCRC16(&out[bodyStart], length));
+}
+
+
+std::string ndiEncodeTX(const ndiTransformReply &reply)
+{
+  std::string s;
+  s.reserve(2 + 70 * reply.handles.size() + 4);
+  appendHex(s, (unsigned int)reply.handles.size(), 2);
+  for (const ndiHandleTransform &t : reply.handles)
+    {
+    appendHex(s, (unsigned int)t.handle, 2);
+    if (t.status == enHandleDisabled)
+      {
+      s += "DISABLED";
+      }
+    else
+      {
+      if (t.status == enHandleValid)
+        {
+        for (int k = 0; k < 4; k++)
+          appendFixed(s, t.q[k], 6, 4);
+        for (int k = 0; k < 3; k++)
+          appendFixed(s, t.t[k], 7, 2);
+        appendFixed(s, t.error, 6, 4);
+        }
+      else
+        {
+        s += "MISSING";
+        }
+      appendHex(s, t.portStatus, 8);
+      appendHex(s, t.frame, 8);
+      }
+    s += '\n';
+    }
+  appendHex(s, reply.systemStatus, 4);
+  return s;
+}
+
+
+void ndiTransformToMatrix(const ndiHandleTransform &transform, double matrix[16])
+{
+  // normalize: TX quaternions are rounded to 4 decimals
+  const double *q = transform.q;
+  double norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+  double w = 1.0, x = 0.0, y = 0.0, z = 0.0;
+  if (norm > 0.0)
+    {
+    w = q[0] / norm;
+    x = q[1] / norm;
+    y = q[2] / norm;
+    z = q[3] / norm;
+    }
+
+  matrix[0] = 1.0 - 2.0 * (y * y + z * z);
+  matrix[1] = 2.0 * (x * y - w * z);
+  matrix[2] = 2.0 * (x * z + w * y);
+  matrix[3] = transform.t[0];
+  matrix[4] = 2.0 * (x * y + w * z);
+  matrix[5] = 1.0 - 2.0 * (x * x + z * z);
+  matrix[6] = 2.0 * (y * z - w * x);
+  matrix[7] = transform.t[1];
+  matrix[8] = 2.0 * (x * z - w * y);
+  matrix[9] = 2.0 * (y * z + w * x);
+  matrix[10] = 1.0 - 2.0 * (x * x + y * y);
+  matrix[11] = transform.t[2];
+  matrix[12] = matrix[13] = matrix[14] = 0.0;
+  matrix[15] = 1.0;
+}
@@ -0,0 +1,162 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiProtocol.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __NDIPROTOCOL_H__
+#define __NDIPROTOCOL_H__
+
+#pragma once
+
+// C++ includes
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+* Framing and parsing of the NDI combined API (Polaris, Aurora, Vega serial
+* protocol): commands with CRC, ASCII replies, and the transformation data of
+* the TX (ASCII) and BX (binary) tracking replies, option 0x0001.
+*
+* These are pure functions on byte buffers, shared by the binary tracker
+* client and the serial device emulator.
+*/
+
+//! CRC-16 of the NDI API (CRC-16/ARC: reflected polynomial 0xA001, initial value 0)
+unsigned int ndiCRC16(const unsigned char *data, size_t n, unsigned int crc = 0);
+unsigned int ndiCRC16(const std::string &s);
+
+//! baud rates of the COMM command, and their codes
+struct ndiBaudRate
+  {
+  int   baud;
+  char  code;
+  };
+
+//! all rates COMM accepts, highest first
+const std::vector<ndiBaudRate> &ndiBaudRates();
+
+//! COMM code of baud, 0 if the rate is not supported
+char ndiBaudCode(int baud);
+
+//! baud rate of a COMM code, 0 if the code is not valid
+int ndiBaudFromCode(char code);
+
+/*!
+* "NAME:params" followed by the CRC of that text and a carriage return. The
+* colon instead of a space tells the system that the command carries a CRC.
+*/
+std::string ndiFormatCommand(const std::string &name, const std::string &params = std::string());
+
+//! split a received command line (without the CR) into name and params; checks the CRC if present
+bool ndiParseCommand(const std::string &line, std::string &name, std::string &params);
+
+//! reply text followed by its CRC and a carriage return
+std::string ndiFormatReply(const std::string &body);
+
+//! verify and strip the CRC of an ASCII reply (without the CR)
+bool ndiCheckReply(const std::string &reply, std::string &body);
+
+//! handle status byte of BX replies
+enum ndiHandleStatus
+  {
+  enHandleValid = 0x01,
+  enHandleMissing = 0x02,
+  enHandleDisabled = 0x04
+  };
+
+//! port status bits used here
+enum ndiPortStatus
+  {
+  enPortOccupied = 0x0001,
+  enPortInitialized = 0x0010,
+  enPortEnabled = 0x0020,
+  enPortOutOfVolume = 0x0080,
+  enPortPartiallyInVolume = 0x0100
+  };
+
+//! transformation of one port handle
+struct ndiHandleTransform
+  {
+  int           handle = 0;
+  int           status = enHandleMissing;
+  double        q[4] = { 1.0, 0.0, 0.0, 0.0 };  // q0, qx, qy, qz
+  double        t[3] = { 0.0, 0.0, 0.0 };       // mm
+  double        error = 0.0;                    // RMS, mm
+  unsigned int  portStatus = 0;
+  unsigned int  frame = 0;
+  };
+
+//! one TX/BX reply
+struct ndiTransformReply
+  {
+  std::vector<ndiHandleTransform> handles;
+  unsigned int                    systemStatus = 0;
+  };
+
+//! first two bytes of every binary reply (0xA5C4, little-endian)
+const unsigned int ndiBinaryStart = 0xA5C4;
+
+//! size of the header of a binary reply: start, body length, header CRC
+const size_t ndiBinaryHeaderSize = 6;
+
+/*!
+* Parse a BX reply (option 0x0001) from the start of data. Returns the number
+* of bytes used, 0 if data does not hold a complete reply yet, and -1 if the
+* reply is malformed or a CRC does not match.
+*/
+long ndiParseBX(const unsigned char *data, size_t n, ndiTransformReply &reply);
+
+//! parse the body of a TX reply (option 0x0001), without CRC and CR
+bool ndiParseTX(const std::string &body, ndiTransformReply &reply);
+
+//! the BX reply of reply, appended to out
+void ndiEncodeBX(const ndiTransformReply &reply, std::vector<unsigned char> &out);
+
+//! the body of the TX reply of reply, without CRC and CR
+std::string ndiEncodeTX(const ndiTransformReply &reply);
+
+//! row-major 4x4 transformation of a valid handle
+void ndiTransformToMatrix(const ndiHandleTransform &transform, double matrix[16]);
+
+#endif // of __NDIPROTOCOL_H__
@@ -0,0 +1,397 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiSerialLink.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "ndiSerialLink.h"
+
+// C++ includes
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+#ifndef _WIN32
+speed_t termiosSpeed(int baud)
+{
+  switch (baud)
+    {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+#ifdef B230400
+    case 230400: return B230400;
+#endif
+#ifdef B921600
+    case 921600: return B921600;
+#endif
+    default: return 0;
+    }
+}
+#endif
+} // namespace
+
+
+ndiSerialLink::ndiSerialLink()
+{
+#ifdef _WIN32
+  handle = nullptr;
+  readTimeoutMs = -1;
+#else
+  fd = -1;
+#endif
+  baudRate = 0;
+  start = 0;
+  bytesRead = bytesWritten = 0;
+}
+
+
+ndiSerialLink::~ndiSerialLink()
+{
+  this->close();
+}
+
+
+bool ndiSerialLink::open(const std::string &device)
+{
+  this->close();
+#ifdef _WIN32
+  // COM10 and above are only reachable through the device namespace
+  std::string name = device;
+  if (name.compare(0, 4, "\\\\.\\") != 0)
+    name = "\\\\.\\" + name;
+  HANDLE h = CreateFileA(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+  if (h == INVALID_HANDLE_VALUE)
+    return false;
+  handle = h;
+
+  DCB dcb;
+  std::memset(&dcb, 0, sizeof(dcb));
+  dcb.DCBlength = sizeof(dcb);
+  if (!GetCommState(h, &dcb))
+    {
+    this->close();
+    return false;
+    }
+  dcb.fBinary = TRUE;
+  dcb.fParity = FALSE;
+  dcb.fOutxCtsFlow = FALSE;
+  dcb.fOutxDsrFlow = FALSE;
+  dcb.fDtrControl = DTR_CONTROL_ENABLE;
+  dcb.fDsrSensitivity = FALSE;
+  dcb.fOutX = FALSE;
+  dcb.fInX = FALSE;
+  dcb.fErrorChar = FALSE;
+  dcb.fNull = FALSE;
+  dcb.fRtsControl = RTS_CONTROL_ENABLE;
+  dcb.fAbortOnError = FALSE;
+  dcb.ByteSize = 8;
+  dcb.Parity = NOPARITY;
+  dcb.StopBits = ONESTOPBIT;
+  if (!SetCommState(h, &dcb) || !this->setBaudRate(9600))
+    {
+    this->close();
+    return false;
+    }
+  SetupComm(h, 65536, 4096);
+  this->discardInput();
+  return true;
+#else
+  fd = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0)
+    return false;
+
+  termios tio;
+  if (tcgetattr(fd, &tio) != 0)
+    {
+    this->close();
+    return false;
+    }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  if (tcsetattr(fd, TCSANOW, &tio) != 0 || !this->setBaudRate(9600))
+    {
+    this->close();
+    return false;
+    }
+  this->discardInput();
+  return true;
+#endif
+}
+
+
+void ndiSerialLink::close()
+{
+#ifdef _WIN32
+  if (handle)
+    CloseHandle(handle);
+  handle = nullptr;
+  readTimeoutMs = -1;
+#else
+  if (fd >= 0)
+    ::close(fd);
+  fd = -1;
+#endif
+  baudRate = 0;
+  buffer.clear();
+  start = 0;
+}
+
+
+bool ndiSerialLink::setBaudRate(int baud)
+{
+#ifdef _WIN32
+  // the driver decides which rates it can generate, 1228739 included
+  DCB dcb;
+  std::memset(&dcb, 0, sizeof(dcb));
+  dcb.DCBlength = sizeof(dcb);
+  if (!handle || baud <= 0 || !GetCommState(handle, &dcb))
+    return false;
+  dcb.BaudRate = (DWORD)baud;
+  if (!SetCommState(handle, &dcb))
+    return false;
+  baudRate = baud;
+  return true;
+#else
+  speed_t speed = termiosSpeed(baud);
+  termios tio;
+  if (fd < 0 || speed == 0 || tcgetattr(fd, &tio) != 0)
+    return false;
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  if (tcsetattr(fd, TCSADRAIN, &tio) != 0)
+    return false;
+  baudRate = baud;
+  return true;
+#endif
+}
+
+
+void ndiSerialLink::sendBreak()
+{
+#ifdef _WIN32
+  // as long as tcsendbreak(): at least 0.25 s
+  if (handle && SetCommBreak(handle))
+    {
+    Sleep(250);
+    ClearCommBreak(handle);
+    }
+#else
+  if (fd >= 0)
+    tcsendbreak(fd, 0);
+#endif
+}
+
+
+bool ndiSerialLink::write(const std::string &data)
+{
+#ifdef _WIN32
+  size_t done = 0;
+  while (handle && done < data.size())
+    {
+    DWORD n = 0;
+    if (!WriteFile(handle, data.data() + done, (DWORD)(data.size() - done), &n, nullptr) || n == 0)
+      return false;
+    done += n;
+    }
+  bytesWritten += done;
+  return done == data.size();
+#else
+  size_t done = 0;
+  while (fd >= 0 && done < data.size())
+    {
+    ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+    if (n > 0)
+      {
+      done += n;
+      continue;
+      }
+    if (n < 0 && errno != EAGAIN && errno != EINTR)
+      return false;
+    pollfd p = { fd, POLLOUT, 0 };
+    if (poll(&p, 1, 1000) <= 0)
+      return false;
+    }
+  bytesWritten += done;
+  return done == data.size();
+#endif
+}
+
+
+void ndiSerialLink::discardInput()
+{
+#ifdef _WIN32
+  if (handle)
+    PurgeComm(handle, PURGE_RXCLEAR);
+#else
+  if (fd >= 0)
+    tcflush(fd, TCIFLUSH);
+#endif
+  buffer.clear();
+  start = 0;
+}
+
+
+bool ndiSerialLink::fill(int timeoutMs)
+{
+#ifdef _WIN32
+  if (!handle)
+    return false;
+  timeoutMs = std::max(0, timeoutMs);
+  if (timeoutMs != readTimeoutMs)
+    {
+    // ReadFile returns as soon as anything has arrived, or after timeoutMs.
+    // A zero constant with these multipliers would wait forever, so a zero
+    // timeout uses the plain non-blocking setting instead.
+    COMMTIMEOUTS timeouts;
+    std::memset(&timeouts, 0, sizeof(timeouts));
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    if (timeoutMs > 0)
+      {
+      timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+      timeouts.ReadTotalTimeoutConstant = (DWORD)timeoutMs;
+      }
+    timeouts.WriteTotalTimeoutConstant = 1000;
+    if (!SetCommTimeouts(handle, &timeouts))
+      return false;
+    readTimeoutMs = timeoutMs;
+    }
+#else
+  if (fd < 0)
+    return false;
+  pollfd p = { fd, POLLIN, 0 };
+  if (poll(&p, 1, timeoutMs) <= 0)
+    return false;
+#endif
+
+  // drop the consumed bytes before growing the buffer
+  if (start > 0 && start == buffer.size())
+    {
+    buffer.clear();
+    start = 0;
+    }
+  else if (start > 4096)
+    {
+    buffer.erase(buffer.begin(), buffer.begin() + start);
+    start = 0;
+    }
+
+  unsigned char chunk[4096];
+#ifdef _WIN32
+  DWORD n = 0;
+  if (!ReadFile(handle, chunk, sizeof(chunk), &n, nullptr) || n == 0)
+    return false;
+#else
+  ssize_t n = ::read(fd, chunk, sizeof(chunk));
+  if (n <= 0)
+    return false;
+#endif
+  buffer.insert(buffer.end(), chunk, chunk + n);
+  bytesRead += n;
+  return true;
+}
+
+
+bool ndiSerialLink::waitForBytes(size_t n, int timeoutMs)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  while (this->available() < n)
+    {
+    int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+    if (left < 0 || (!this->fill(left) && std::chrono::steady_clock::now() >= deadline))
+      return false;
+    }
+  return true;
+}
+
+
+void ndiSerialLink::consume(size_t n)
+{
+  start = std::min(buffer.size(), start + n);
+}
+
+
+bool ndiSerialLink::readLine(std::string &line, int timeoutMs)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  size_t searched = 0;
+  for (;;)
+    {
+    const unsigned char *begin = this->data(), *end = begin + this->available();
+    const unsigned char *cr = std::find(begin + searched, end, (unsigned char)'\r');
+    if (cr != end)
+      {
+      line.assign((const char *)begin, cr - begin);
+      this->consume(cr - begin + 1);
+      return true;
+      }
+    searched = this->available();
+
+    int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+    if (left < 0 || (!this->fill(left) && std::chrono::steady_clock::now() >= deadline))
+      return false;
+    }
+}
@@ -0,0 +1,123 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: ndiSerialLink.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __NDISERIALLINK_H__
+#define __NDISERIALLINK_H__
+
+#pragma once
+
+// C++ includes
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+* Raw 8N1 serial line with a receive buffer, as used by the NDI systems:
+* termios on POSIX hosts, the COMM API on Windows. Also works on the slave
+* side of a pseudo-terminal, where the baud rate is accepted but has no effect.
+*/
+class ndiSerialLink
+{
+public:
+  ndiSerialLink();
+  ~ndiSerialLink();
+
+  //! open device at 9600 baud, the rate of the NDI systems after a reset
+  bool open(const std::string &device);
+  void close();
+#ifdef _WIN32
+  bool isOpen() const { return handle != nullptr; }
+#else
+  bool isOpen() const { return fd >= 0; }
+#endif
+
+  /*!
+  * False if the host cannot set this rate. POSIX hosts only set the standard
+  * termios rates, up to 921600; on Windows the driver decides, and the NDI
+  * USB converters accept 1228739.
+  */
+  bool setBaudRate(int baud);
+  int getBaudRate() const { return baudRate; }
+
+  //! hold the line in break state, which resets the NDI systems to 9600 baud
+  void sendBreak();
+
+  bool write(const std::string &data);
+
+  //! discard any received data
+  void discardInput();
+
+  /*!
+  * Wait until at least n received bytes are buffered, or timeoutMs have
+  * passed. The buffered bytes are available with data() until consume().
+  */
+  bool waitForBytes(size_t n, int timeoutMs);
+  const unsigned char *data() const { return buffer.data() + start; }
+  size_t available() const { return buffer.size() - start; }
+  void consume(size_t n);
+
+  //! read up to the next carriage return, which is consumed but not returned
+  bool readLine(std::string &line, int timeoutMs);
+
+  long long getBytesRead() const { return bytesRead; }
+  long long getBytesWritten() const { return bytesWritten; }
+
+private:
+  //! append whatever is readable within timeoutMs to the buffer
+  bool fill(int timeoutMs);
+
+#ifdef _WIN32
+  void                        *handle;        // HANDLE of the COM port, nullptr if closed
+  int                         readTimeoutMs;  // as last set with SetCommTimeouts()
+#else
+  int                         fd;
+#endif
+  int                         baudRate;
+  std::vector<unsigned char>  buffer;
+  size_t                      start;      // first unconsumed byte of buffer
+  long long                   bytesRead, bytesWritten;
+};
+
+#endif // of __NDISERIALLINK_H__
@@ -0,0 +1,144 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: pivotCalibration.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "pivotCalibration.h"
+
+// VTK includes
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+
+// C++ includes
+#include <cmath>
+
+
+pivotCalibration::pivotCalibration()
+{
+  this->reset();
+}
+
+
+void pivotCalibration::reset()
+{
+  for (int i = 0; i < 6; i++)
+    {
+    for (int j = 0; j < 6; j++)
+      AtA[i][j] = 0.0;
+    Atb[i] = 0.0;
+    }
+  btb = 0.0;
+  numPoses = 0;
+}
+
+
+void pivotCalibration::addPose(vtkMatrix4x4 *m)
+{
+  this->addPose(&m->Element[0][0]);
+}
+
+
+void pivotCalibration::addPose(const double m[16])
+{
+  // A = [R -I] is 3x6, b = t
+  double A[3][6];
+  double t[3] = { m[3], m[7], m[11] };
+
+  for (int r = 0; r < 3; r++)
+    {
+    for (int c = 0; c < 3; c++)
+      {
+      A[r][c] = m[4 * r + c];
+      A[r][c + 3] = (r == c) ? -1.0 : 0.0;
+      }
+    }
+
+  for (int i = 0; i < 6; i++)
+    {
+    for (int j = i; j < 6; j++)
+      AtA[i][j] += A[0][i] * A[0][j] + A[1][i] * A[1][j] + A[2][i] * A[2][j];
+    Atb[i] += A[0][i] * t[0] + A[1][i] * t[1] + A[2][i] * t[2];
+    }
+  btb += t[0] * t[0] + t[1] * t[1] + t[2] * t[2];
+
+  numPoses++;
+}
+
+
+double pivotCalibration::solve(double tip[3], double pivot[3]) const
+{
+  if (numPoses < 2)
+    return -1.0;
+
+  // minimize |A z + b|^2  =>  (A^T A) z = -A^T b
+  double M[6][6], *rows[6], z[6];
+  for (int i = 0; i < 6; i++)
+    {
+    for (int j = 0; j < 6; j++)
+      M[i][j] = (j >= i) ? AtA[i][j] : AtA[j][i];
+    rows[i] = M[i];
+    z[i] = -Atb[i];
+    }
+
+  if (!vtkMath::SolveLinearSystem(rows, z, 6))
+    return -1.0;
+
+  // sum of squared residuals: z^T (A^T A) z + 2 z^T (A^T b) + b^T b
+  double ssr = btb;
+  for (int i = 0; i < 6; i++)
+    {
+    double row = 0.0;
+    for (int j = 0; j < 6; j++)
+      row += ((j >= i) ? AtA[i][j] : AtA[j][i]) * z[j];
+    ssr += z[i] * row + 2.0 * z[i] * Atb[i];
+    }
+
+  for (int i = 0; i < 3; i++)
+    {
+    tip[i] = z[i];
+    pivot[i] = z[i + 3];
+    }
+
+  return std::sqrt((ssr > 0.0 ? ssr : 0.0) / numPoses);
+}
@@ -0,0 +1,91 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: pivotCalibration.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __PIVOTCALIBRATION_H__
+#define __PIVOTCALIBRATION_H__
+
+#pragma once
+
+// VTK forward declaration
+class vtkMatrix4x4;
+
+/*!
+* Least-squares pivot calibration of a tracked stylus.
+*
+* For every pose [R|t] of the stylus pivoting about a fixed point, the tip
+* offset x (in the tool frame) and the pivot p (in the tracker frame) satisfy
+* R x + t = p. The normal equations and the sum of squared residuals are
+* accumulated as poses arrive, so memory use is constant in the number of poses.
+*/
+class pivotCalibration
+{
+public:
+  pivotCalibration();
+
+  //! discard all accumulated poses
+  void reset();
+
+  //! add a row-major 4x4 homogeneous pose
+  void addPose(const double m[16]);
+  void addPose(vtkMatrix4x4 *m);
+
+  int getNumberOfPoses() const { return numPoses; }
+
+  /*!
+  * Solve for the tip offset and the pivot location.
+  *
+  * Returns the RMS residual (mm), or -1 if fewer than 2 poses were added or
+  * the poses do not constrain the solution (e.g. no rotation).
+  */
+  double solve(double tip[3], double pivot[3]) const;
+
+private:
+  double AtA[6][6];   // sum of A^T A, A = [R -I]
+  double Atb[6];      // sum of A^T t
+  double btb;         // sum of t^T t
+  int    numPoses;
+};
+
+#endif // of __PIVOTCALIBRATION_H__
@@ -0,0 +1,301 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: planeMeshSlicer.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "planeMeshSlicer.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+
+namespace
+{
+const int maxLeafSize = 4;
+} // namespace
+
+
+planeMeshSlicer::planeMeshSlicer()
+{
+  contourPoints = vtkSmartPointer<vtkPoints>::New();
+  contourPoints->SetDataTypeToFloat();
+  contourLines = vtkSmartPointer<vtkCellArray>::New();
+}
+
+
+void planeMeshSlicer::setMesh(vtkPolyData *mesh)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  points.clear();
+  triangles.clear();
+  nodes.clear();
+
+  if (mesh && mesh->GetPoints())
+    {
+    vtkIdType nPts = mesh->GetNumberOfPoints();
+    points.resize(3 * (size_t)nPts);
+    double p[3];
+    for (vtkIdType i = 0; i < nPts; i++)
+      {
+      mesh->GetPoint(i, p);
+      points[3 * i] = (float)p[0];
+      points[3 * i + 1] = (float)p[1];
+      points[3 * i + 2] = (float)p[2];
+      }
+
+    // fan-triangulate the polygons
+    vtkIdType npts, *pts;
+    vtkCellArray *polys = mesh->GetPolys();
+    triangles.reserve(3 * (size_t)polys->GetNumberOfCells());
+    for (polys->InitTraversal(); polys->GetNextCell(npts, pts); )
+      {
+      for (vtkIdType k = 1; k + 1 < npts; k++)
+        {
+        triangles.push_back((int)pts[0]);
+        triangles.push_back((int)pts[k]);
+        triangles.push_back((int)pts[k + 1]);
+        }
+      }
+    }
+
+  int nTri = (int)(triangles.size() / 3);
+  if (nTri > 0)
+    {
+    std::vector<float> centroids(3 * (size_t)nTri);
+    for (int t = 0; t < nTri; t++)
+      {
+      for (int j = 0; j < 3; j++)
+        {
+        centroids[3 * t + j] = (points[3 * triangles[3 * t] + j] + points[3 * triangles[3 * t + 1] + j] +
+          points[3 * triangles[3 * t + 2] + j]) / 3.0f;
+        }
+      }
+
+    std::vector<int> order(nTri);
+    std::iota(order.begin(), order.end(), 0);
+    nodes.reserve(2 * (size_t)nTri / maxLeafSize + 1);
+    this->build(0, nTri, order, centroids);
+
+    // store the triangles in leaf order so that each leaf is contiguous in memory
+    std::vector<int> sorted(triangles.size());
+    for (int t = 0; t < nTri; t++)
+      std::copy(&triangles[3 * order[t]], &triangles[3 * order[t]] + 3, &sorted[3 * t]);
+    triangles.swap(sorted);
+    }
+
+  stats = statistics();
+  stats.numTriangles = nTri;
+  stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+int planeMeshSlicer::build(int first, int count, std::vector<int> &order, const std::vector<float> &centroids)
+{
+  int idx = (int)nodes.size();
+  nodes.push_back(node());
+
+  // bounds of the triangles, and of their centroids to choose the split
+  float bmin[3] = { 1e30f, 1e30f, 1e30f }, bmax[3] = { -1e30f, -1e30f, -1e30f };
+  float cmin[3] = { 1e30f, 1e30f, 1e30f }, cmax[3] = { -1e30f, -1e30f, -1e30f };
+  for (int i = first; i < first + count; i++)
+    {
+    const int *tri = &triangles[3 * order[i]];
+    for (int v = 0; v < 3; v++)
+      {
+      for (int j = 0; j < 3; j++)
+        {
+        float x = points[3 * tri[v] + j];
+        bmin[j] = std::min(bmin[j], x);
+        bmax[j] = std::max(bmax[j], x);
+        }
+      }
+    for (int j = 0; j < 3; j++)
+      {
+      cmin[j] = std::min(cmin[j], centroids[3 * order[i] + j]);
+      cmax[j] = std::max(cmax[j], centroids[3 * order[i] + j]);
+      }
+    }
+
+  for (int j = 0; j < 3; j++)
+    {
+    nodes[idx].bmin[j] = bmin[j];
+    nodes[idx].bmax[j] = bmax[j];
+    }
+  nodes[idx].first = first;
+  nodes[idx].count = count;
+  nodes[idx].right = -1;
+
+  if (count <= maxLeafSize)
+    return idx;
+
+  // median split along the longest axis of the centroid bounds
+  int axis = 0;
+  for (int j = 1; j < 3; j++)
+    if (cmax[j] - cmin[j] > cmax[axis] - cmin[axis])
+      axis = j;
+
+  int mid = first + count / 2;
+  std::nth_element(order.begin() + first, order.begin() + mid, order.begin() + first + count,
+    [&centroids, axis](int a, int b) { return centroids[3 * a + axis] < centroids[3 * b + axis]; });
+
+  nodes[idx].count = 0;
+  this->build(first, mid - first, order, centroids);
+  int right = this->build(mid, first + count - mid, order, centroids);
+  nodes[idx].right = right;
+
+  return idx;
+}
+
+
+int planeMeshSlicer::slice(const double origin[3], const double normal[3], vtkPolyData *output)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  contourPoints->Reset();
+  contourLines->Reset();
+  edgePoints.clear();
+  stats.nodesVisited = stats.trianglesTested = stats.segments = 0;
+
+  double len = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+  if (len > 0.0 && !nodes.empty())
+    {
+    const double n[3] = { normal[0] / len, normal[1] / len, normal[2] / len };
+    const double d = n[0] * origin[0] + n[1] * origin[1] + n[2] * origin[2];
+    const double an[3] = { std::fabs(n[0]), std::fabs(n[1]), std::fabs(n[2]) };
+
+    // contour point on the cut edge (a, b), shared by the two triangles using the edge
+    auto edgePoint = [&](int a, int b, double da, double db) -> vtkIdType
+      {
+      uint64_t key = (a < b) ? ((uint64_t)a << 32 | (uint32_t)b) : ((uint64_t)b << 32 | (uint32_t)a);
+      auto it = edgePoints.find(key);
+      if (it != edgePoints.end())
+        return (vtkIdType)it->second;
+
+      double s = da / (da - db);
+      const float *pa = &points[3 * a], *pb = &points[3 * b];
+      vtkIdType id = contourPoints->InsertNextPoint(pa[0] + s * (pb[0] - pa[0]),
+        pa[1] + s * (pb[1] - pa[1]), pa[2] + s * (pb[2] - pa[2]));
+      edgePoints.emplace(key, (long long)id);
+      return id;
+      };
+
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty())
+      {
+      const node &nd = nodes[stack.back()];
+      int idx = stack.back();
+      stack.pop_back();
+      stats.nodesVisited++;
+
+      // plane / box overlap: distance of the centre against the projected half extent
+      double c[3], e[3];
+      for (int j = 0; j < 3; j++)
+        {
+        c[j] = 0.5 * ((double)nd.bmin[j] + nd.bmax[j]);
+        e[j] = 0.5 * ((double)nd.bmax[j] - nd.bmin[j]);
+        }
+      double dist = n[0] * c[0] + n[1] * c[1] + n[2] * c[2] - d;
+      if (std::fabs(dist) > an[0] * e[0] + an[1] * e[1] + an[2] * e[2])
+        continue;
+
+      if (nd.count == 0)
+        {
+        stack.push_back(nd.right);
+        stack.push_back(idx + 1);
+        continue;
+        }
+
+      for (int t = nd.first; t < nd.first + nd.count; t++)
+        {
+        const int *tri = &triangles[3 * t];
+        double dv[3];
+        for (int v = 0; v < 3; v++)
+          {
+          const float *p = &points[3 * tri[v]];
+          dv[v] = n[0] * p[0] + n[1] * p[1] + n[2] * p[2] - d;
+          }
+        stats.trianglesTested++;
+
+        bool s0 = dv[0] >= 0.0, s1 = dv[1] >= 0.0, s2 = dv[2] >= 0.0;
+        if (s0 == s1 && s1 == s2)
+          continue;
+
+        // exactly two edges change sign
+        vtkIdType ids[2];
+        int k = 0;
+        if (s0 != s1)
+          ids[k++] = edgePoint(tri[0], tri[1], dv[0], dv[1]);
+        if (s1 != s2)
+          ids[k++] = edgePoint(tri[1], tri[2], dv[1], dv[2]);
+        if (k < 2 && s2 != s0)
+          ids[k++] = edgePoint(tri[2], tri[0], dv[2], dv[0]);
+
+        contourLines->InsertNextCell(2, ids);
+        stats.segments++;
+        }
+      }
+    }
+
+  contourPoints->Modified();
+  contourLines->Modified();
+  output->SetPoints(contourPoints);
+  output->SetLines(contourLines);
+  output->Modified();
+
+  stats.sliceMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+  stats.numSlices++;
+  stats.meanSliceMs += (stats.sliceMs - stats.meanSliceMs) / stats.numSlices;
+
+  return stats.segments;
+}
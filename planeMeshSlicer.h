@@ -0,0 +1,125 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: planeMeshSlicer.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __PLANEMESHSLICER_H__
+#define __PLANEMESHSLICER_H__
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+
+// C++ includes
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// VTK forward declaration
+class vtkCellArray;
+class vtkPoints;
+class vtkPolyData;
+
+/*!
+* Intersection contour of a plane with a triangle mesh, for planes that move
+* every frame (e.g. a tracked laser plane).
+*
+* setMesh() builds a bounding volume hierarchy over the triangles once; each
+* slice() only descends into boxes the plane crosses, so its cost follows the
+* number of triangles near the plane rather than the mesh size. The output
+* polydata's points and lines are reset and refilled in place, and contour
+* vertices are shared between neighbouring segments (one per cut mesh edge).
+*/
+class planeMeshSlicer
+{
+public:
+  //! per-update cost of the last slice(), and the cost of setMesh()
+  struct statistics
+    {
+    double    buildMs = 0.0;
+    double    sliceMs = 0.0;
+    double    meanSliceMs = 0.0;      // running mean over all slices
+    long long numSlices = 0;
+    int       numTriangles = 0;
+    int       nodesVisited = 0;
+    int       trianglesTested = 0;
+    int       segments = 0;
+    };
+
+  planeMeshSlicer();
+
+  //! index the triangles of mesh; polygons are fan-triangulated, other cells ignored
+  void setMesh(vtkPolyData *mesh);
+
+  bool hasMesh() const { return !triangles.empty(); }
+
+  /*!
+  * Intersect the mesh with the plane through origin with the given normal
+  * (mesh coordinates) and write line segments into output. Returns the number
+  * of segments.
+  */
+  int slice(const double origin[3], const double normal[3], vtkPolyData *output);
+
+  const statistics &getStatistics() const { return stats; }
+
+private:
+  struct node
+    {
+    float bmin[3], bmax[3];
+    int   first, count;   // leaf: triangle range; internal: count == 0
+    int   right;          // internal: index of the right child (left is this + 1)
+    };
+
+  int build(int first, int count, std::vector<int> &order, const std::vector<float> &centroids);
+
+  std::vector<float>      points;     // xyz
+  std::vector<int>        triangles;  // 3 point ids per triangle, in BVH leaf order
+  std::vector<node>       nodes;
+  std::vector<int>        stack;
+  std::unordered_map<uint64_t, long long> edgePoints; // cut mesh edge -> contour point id
+  vtkSmartPointer<vtkPoints>    contourPoints;
+  vtkSmartPointer<vtkCellArray> contourLines;
+  statistics              stats;
+};
+
+#endif // of __PLANEMESHSLICER_H__
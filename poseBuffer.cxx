@@ -0,0 +1,185 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: poseBuffer.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "poseBuffer.h"
+
+// VTK includes
+#include <vtkMath.h>
+
+// C++ includes
+#include <chrono>
+#include <cmath>
+
+
+double poseClockSeconds()
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+poseBuffer::poseBuffer(int capacity) : samples(capacity > 2 ? capacity : 2), first(0), count(0)
+{
+}
+
+
+void poseBuffer::addPose(double timestamp, const double m[16])
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // drop out-of-order samples
+  if (count > 0 && timestamp <= samples[slot(count - 1)].timestamp)
+    return;
+
+  int idx;
+  if (count < (int)samples.size())
+    {
+    idx = slot(count);
+    count++;
+    }
+  else
+    {
+    // full: overwrite the oldest
+    idx = first;
+    first = (first + 1) % (int)samples.size();
+    }
+
+  samples[idx].timestamp = timestamp;
+  for (int i = 0; i < 16; i++)
+    samples[idx].m[i] = m[i];
+}
+
+
+void poseBuffer::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  first = count = 0;
+}
+
+
+double poseBuffer::getLatestTime() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return count ? samples[slot(count - 1)].timestamp : -1.0;
+}
+
+
+bool poseBuffer::getPose(double t, double m[16], double maxGap) const
+{
+  sample a, b;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0 || t < samples[slot(0)].timestamp || t > samples[slot(count - 1)].timestamp)
+      return false;
+
+    // binary search for the last sample at or before t
+    int lo = 0, hi = count - 1;
+    while (lo < hi)
+      {
+      int mid = (lo + hi + 1) / 2;
+      if (samples[slot(mid)].timestamp <= t)
+        lo = mid;
+      else
+        hi = mid - 1;
+      }
+
+    a = samples[slot(lo)];
+    b = samples[slot(lo + 1 < count ? lo + 1 : lo)];
+  }
+
+  double dt = b.timestamp - a.timestamp;
+  if (dt > maxGap)
+    return false;
+
+  double s = (dt > 0.0) ? (t - a.timestamp) / dt : 0.0;
+
+  // slerp between the two rotations
+  double Ra[3][3], Rb[3][3], qa[4], qb[4], q[4], R[3][3];
+  for (int r = 0; r < 3; r++)
+    {
+    for (int c = 0; c < 3; c++)
+      {
+      Ra[r][c] = a.m[4 * r + c];
+      Rb[r][c] = b.m[4 * r + c];
+      }
+    }
+  vtkMath::Matrix3x3ToQuaternion(Ra, qa);
+  vtkMath::Matrix3x3ToQuaternion(Rb, qb);
+
+  double dot = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+  if (dot < 0.0)
+    {
+    // take the short way round
+    dot = -dot;
+    for (int i = 0; i < 4; i++)
+      qb[i] = -qb[i];
+    }
+
+  double wa = 1.0 - s, wb = s;
+  if (dot < 0.9995)
+    {
+    double theta = std::acos(dot);
+    double sinTheta = std::sin(theta);
+    wa = std::sin((1.0 - s) * theta) / sinTheta;
+    wb = std::sin(s * theta) / sinTheta;
+    }
+  for (int i = 0; i < 4; i++)
+    q[i] = wa * qa[i] + wb * qb[i];
+  double norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+  for (int i = 0; i < 4; i++)
+    q[i] /= norm;
+  vtkMath::QuaternionToMatrix3x3(q, R);
+
+  for (int r = 0; r < 3; r++)
+    {
+    for (int c = 0; c < 3; c++)
+      m[4 * r + c] = R[r][c];
+    m[4 * r + 3] = (1.0 - s) * a.m[4 * r + 3] + s * b.m[4 * r + 3];
+    }
+  m[12] = m[13] = m[14] = 0.0;
+  m[15] = 1.0;
+
+  return true;
+}
@@ -0,0 +1,102 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: poseBuffer.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __POSEBUFFER_H__
+#define __POSEBUFFER_H__
+
+#pragma once
+
+// C++ includes
+#include <mutex>
+#include <vector>
+
+//! monotonic clock (seconds) shared by tracker poses and ultrasound frames
+double poseClockSeconds();
+
+/*!
+* Fixed-capacity ring buffer of timestamped rigid poses.
+*
+* Producers (the tracker update) add poses in time order; consumers (the
+* ultrasound reconstruction workers) ask for the pose at an arbitrary time,
+* which is interpolated between the two bracketing samples (linear in
+* translation, spherical-linear in rotation). All methods are thread safe.
+*/
+class poseBuffer
+{
+public:
+  explicit poseBuffer(int capacity = 1024);
+
+  //! add a row-major 4x4 pose; timestamps must be increasing
+  void addPose(double timestamp, const double m[16]);
+
+  void clear();
+
+  /*!
+  * Interpolate the pose at time t.
+  *
+  * Returns false if t is outside the buffered time range, or if the bracketing
+  * samples are more than maxGap seconds apart (e.g. the tool was not visible).
+  */
+  bool getPose(double t, double m[16], double maxGap = 0.1) const;
+
+  //! time of the most recent pose, or a negative value if empty
+  double getLatestTime() const;
+
+private:
+  struct sample
+    {
+    double timestamp;
+    double m[16];
+    };
+
+  // index of the i-th oldest sample
+  int slot(int i) const { return (first + i) % (int)samples.size(); }
+
+  mutable std::mutex   mutex;
+  std::vector<sample>  samples;
+  int                  first, count;
+};
+
+#endif // of __POSEBUFFER_H__
@@ -0,0 +1,395 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: renderScene.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "renderScene.h"
+#include "traceObserver.h"
+#include "traceRecorder.h"
+
+// VTK includes
+#include <vtkAbstractVolumeMapper.h>
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkCoordinate.h>
+#include <vtkDataObject.h>
+#include <vtkImageData.h>
+#include <vtkLogoRepresentation.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkProperty2D.h>
+#include <vtkPropCollection.h>
+#include <vtkRenderer.h>
+#include <vtkScalarsToColors.h>
+#include <vtkSmartVolumeMapper.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+
+// C++ includes
+#include <algorithm>
+
+
+renderSceneCapture::cachedCopy &renderSceneCapture::lookup(vtkObject *src)
+{
+  cachedCopy &c = copies[src];
+  c.generation = generation;
+  return c;
+}
+
+
+vtkDataObject *renderSceneCapture::copyOf(vtkDataObject *src)
+{
+  cachedCopy &c = this->lookup(src);
+  if (!c.copy || src->GetMTime() > c.mtime)
+    {
+    vtkSmartPointer<vtkDataObject> copy = vtkSmartPointer<vtkDataObject>::Take(src->NewInstance());
+    // images (volumes) are too big to copy on the GUI thread: share their arrays.
+    // Producers never write into scalars they have handed over (see header).
+    if (vtkImageData::SafeDownCast(src))
+      copy->ShallowCopy(src);
+    else
+      copy->DeepCopy(src);
+    c.copy = copy;
+    c.mtime = src->GetMTime();
+    }
+  return static_cast<vtkDataObject *>(c.copy.Get());
+}
+
+
+vtkVolumeProperty *renderSceneCapture::copyOf(vtkVolumeProperty *src)
+{
+  cachedCopy &c = this->lookup(src);
+  if (!c.copy || src->GetMTime() > c.mtime)
+    {
+    vtkSmartPointer<vtkVolumeProperty> copy = vtkSmartPointer<vtkVolumeProperty>::New();
+    copy->DeepCopy(src);
+    c.copy = copy;
+    c.mtime = src->GetMTime();
+    }
+  return static_cast<vtkVolumeProperty *>(c.copy.Get());
+}
+
+
+vtkScalarsToColors *renderSceneCapture::copyOf(vtkScalarsToColors *src)
+{
+  cachedCopy &c = this->lookup(src);
+  if (!c.copy || src->GetMTime() > c.mtime)
+    {
+    vtkSmartPointer<vtkScalarsToColors> copy = vtkSmartPointer<vtkScalarsToColors>::Take(src->NewInstance());
+    copy->DeepCopy(src);
+    c.copy = copy;
+    c.mtime = src->GetMTime();
+    }
+  return static_cast<vtkScalarsToColors *>(c.copy.Get());
+}
+
+
+vtkTextProperty *renderSceneCapture::copyOf(vtkTextProperty *src)
+{
+  cachedCopy &c = this->lookup(src);
+  if (!c.copy || src->GetMTime() > c.mtime)
+    {
+    vtkSmartPointer<vtkTextProperty> copy = vtkSmartPointer<vtkTextProperty>::New();
+    copy->ShallowCopy(src); // only plain values
+    c.copy = copy;
+    c.mtime = src->GetMTime();
+    }
+  return static_cast<vtkTextProperty *>(c.copy.Get());
+}
+
+
+void renderSceneCapture::capture(vtkRenderer *ren, int width, int height, renderSceneState &state)
+{
+  AIGS_TRACE_SCOPE("renderSceneCapture::capture");
+  generation++;
+
+  state.width = width;
+  state.height = height;
+  ren->GetBackground(state.background);
+
+  vtkCamera *camera = ren->GetActiveCamera();
+  camera->GetPosition(state.cameraPosition);
+  camera->GetFocalPoint(state.cameraFocalPoint);
+  camera->GetViewUp(state.cameraViewUp);
+  state.cameraViewAngle = camera->GetViewAngle();
+  state.cameraParallelScale = camera->GetParallelScale();
+  state.cameraParallel = camera->GetParallelProjection() != 0;
+
+  state.props.clear();
+  vtkPropCollection *props = ren->GetViewProps();
+  vtkCollectionSimpleIterator it;
+  props->InitTraversal(it);
+  while (vtkProp *prop = props->GetNextProp(it))
+    {
+    renderPropState ps;
+    ps.source = prop;
+    ps.visible = prop->GetVisibility() != 0;
+
+    if (vtkActor *actor = vtkActor::SafeDownCast(prop))
+      {
+      vtkPolyDataMapper *mapper = vtkPolyDataMapper::SafeDownCast(actor->GetMapper());
+      if (!mapper || mapper->GetNumberOfInputConnections(0) == 0)
+        continue;
+      mapper->Update(); // mappers fed by a pipeline only update when rendered
+      if (!mapper->GetInput())
+        continue;
+
+      ps.type = renderPropState::enPolyDataActor;
+      ps.data = this->copyOf(mapper->GetInput());
+      vtkMatrix4x4::DeepCopy(ps.matrix, actor->GetMatrix());
+      ps.scalarVisibility = mapper->GetScalarVisibility() != 0;
+      mapper->GetScalarRange(ps.scalarRange);
+      if (ps.scalarVisibility)
+        ps.lookupTable = this->copyOf(mapper->GetLookupTable());
+
+      vtkProperty *p = actor->GetProperty();
+      p->GetColor(ps.color);
+      ps.opacity = p->GetOpacity();
+      ps.lineWidth = p->GetLineWidth();
+      ps.pointSize = p->GetPointSize();
+      ps.specular = p->GetSpecular();
+      ps.lighting = p->GetLighting();
+      }
+    else if (vtkVolume *volume = vtkVolume::SafeDownCast(prop))
+      {
+      vtkAbstractVolumeMapper *mapper = volume->GetMapper();
+      if (!mapper || !mapper->GetDataObjectInput() || !volume->GetProperty())
+        continue;
+
+      ps.type = renderPropState::enVolume;
+      ps.data = this->copyOf(mapper->GetDataObjectInput());
+      ps.volumeProperty = this->copyOf(volume->GetProperty());
+      vtkMatrix4x4::DeepCopy(ps.matrix, volume->GetMatrix());
+      }
+    else if (vtkLogoRepresentation *logo = vtkLogoRepresentation::SafeDownCast(prop))
+      {
+      if (!logo->GetImage())
+        continue;
+
+      ps.type = renderPropState::enLogo;
+      ps.data = this->copyOf(logo->GetImage());
+      std::copy(logo->GetPosition(), logo->GetPosition() + 2, ps.position);
+      std::copy(logo->GetPosition2(), logo->GetPosition2() + 2, ps.position2);
+      ps.opacity = logo->GetImageProperty()->GetOpacity();
+      }
+    else if (vtkTextActor *text = vtkTextActor::SafeDownCast(prop))
+      {
+      if (!text->GetInput())
+        continue;
+
+      ps.type = renderPropState::enText;
+      ps.text = text->GetInput();
+      ps.positionCoordinates = text->GetPositionCoordinate()->GetCoordinateSystem();
+      double *value = text->GetPositionCoordinate()->GetValue();
+      std::copy(value, value + 2, ps.position);
+      ps.textProperty = this->copyOf(text->GetTextProperty());
+      }
+    else
+      {
+      continue;
+      }
+
+    state.props.push_back(ps);
+    }
+
+  // forget the copies of objects that have left the scene
+  for (auto c = copies.begin(); c != copies.end(); )
+    {
+    if (c->second.generation != generation)
+      c = copies.erase(c);
+    else
+      ++c;
+    }
+}
+
+
+renderSceneMirror::~renderSceneMirror()
+{
+  this->clear();
+}
+
+
+void renderSceneMirror::clear()
+{
+  if (renderer)
+    {
+    for (auto &m : mirrors)
+      renderer->RemoveViewProp(m.second.prop);
+    }
+  mirrors.clear();
+  renderer = nullptr;
+}
+
+
+void renderSceneMirror::apply(const renderSceneState &state, vtkRenderer *ren)
+{
+  AIGS_TRACE_SCOPE("renderSceneMirror::apply");
+  if (renderer != ren)
+    {
+    this->clear();
+    renderer = ren;
+    }
+  generation++;
+
+  ren->SetBackground(state.background[0], state.background[1], state.background[2]);
+
+  vtkCamera *camera = ren->GetActiveCamera();
+  camera->SetPosition(state.cameraPosition);
+  camera->SetFocalPoint(state.cameraFocalPoint);
+  camera->SetViewUp(state.cameraViewUp);
+  camera->SetViewAngle(state.cameraViewAngle);
+  camera->SetParallelScale(state.cameraParallelScale);
+  camera->SetParallelProjection(state.cameraParallel);
+
+  for (const renderPropState &ps : state.props)
+    {
+    mirrorProp &m = mirrors[ps.source];
+    if (!m.prop || m.type != ps.type)
+      {
+      if (m.prop)
+        ren->RemoveViewProp(m.prop);
+
+      m.type = ps.type;
+      m.matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+      if (ps.type == renderPropState::enPolyDataActor)
+        {
+        vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
+        actor->SetMapper(vtkSmartPointer<vtkPolyDataMapper>::New());
+        actor->SetUserMatrix(m.matrix);
+        m.prop = actor;
+        }
+      else if (ps.type == renderPropState::enVolume)
+        {
+        vtkSmartPointer<vtkVolume> volume = vtkSmartPointer<vtkVolume>::New();
+        vtkSmartPointer<vtkSmartVolumeMapper> mapper = vtkSmartPointer<vtkSmartVolumeMapper>::New();
+        mapper->SetBlendModeToComposite();
+        traceVolumeMapper(mapper);
+        volume->SetMapper(mapper);
+        volume->SetUserMatrix(m.matrix);
+        m.prop = volume;
+        }
+      else if (ps.type == renderPropState::enLogo)
+        {
+        vtkSmartPointer<vtkLogoRepresentation> logo = vtkSmartPointer<vtkLogoRepresentation>::New();
+        logo->SetRenderer(ren);
+        m.prop = logo;
+        }
+      else
+        {
+        m.prop = vtkSmartPointer<vtkTextActor>::New();
+        }
+      ren->AddViewProp(m.prop);
+      }
+    m.generation = generation;
+    m.prop->SetVisibility(ps.visible);
+
+    if (ps.type == renderPropState::enPolyDataActor)
+      {
+      vtkActor *actor = static_cast<vtkActor *>(m.prop.Get());
+      vtkPolyDataMapper *mapper = static_cast<vtkPolyDataMapper *>(actor->GetMapper());
+      if (mapper->GetInput() != ps.data)
+        mapper->SetInputData(vtkPolyData::SafeDownCast(ps.data));
+      mapper->SetScalarVisibility(ps.scalarVisibility);
+      mapper->SetScalarRange(ps.scalarRange[0], ps.scalarRange[1]);
+      if (ps.lookupTable && mapper->GetLookupTable() != ps.lookupTable.Get())
+        mapper->SetLookupTable(ps.lookupTable);
+      m.matrix->DeepCopy(ps.matrix);
+
+      vtkProperty *p = actor->GetProperty();
+      p->SetColor(ps.color[0], ps.color[1], ps.color[2]);
+      p->SetOpacity(ps.opacity);
+      p->SetLineWidth(ps.lineWidth);
+      p->SetPointSize(ps.pointSize);
+      p->SetSpecular(ps.specular);
+      p->SetLighting(ps.lighting);
+      }
+    else if (ps.type == renderPropState::enVolume)
+      {
+      vtkVolume *volume = static_cast<vtkVolume *>(m.prop.Get());
+      vtkAbstractVolumeMapper *mapper = volume->GetMapper();
+      if (mapper->GetDataObjectInput() != ps.data)
+        mapper->SetInputDataObject(ps.data);
+      if (volume->GetProperty() != ps.volumeProperty)
+        volume->SetProperty(ps.volumeProperty);
+      m.matrix->DeepCopy(ps.matrix);
+      }
+    else if (ps.type == renderPropState::enLogo)
+      {
+      vtkLogoRepresentation *logo = static_cast<vtkLogoRepresentation *>(m.prop.Get());
+      if (logo->GetImage() != ps.data)
+        logo->SetImage(vtkImageData::SafeDownCast(ps.data));
+      logo->SetPosition(ps.position[0], ps.position[1]);
+      logo->SetPosition2(ps.position2[0], ps.position2[1]);
+      logo->GetImageProperty()->SetOpacity(ps.opacity);
+      }
+    else
+      {
+      vtkTextActor *text = static_cast<vtkTextActor *>(m.prop.Get());
+      text->SetInput(ps.text.c_str());
+      text->GetPositionCoordinate()->SetCoordinateSystem(ps.positionCoordinates);
+      text->GetPositionCoordinate()->SetValue(ps.position[0], ps.position[1]);
+      if (text->GetTextProperty() != ps.textProperty.Get())
+        text->SetTextProperty(ps.textProperty);
+      }
+    }
+
+  for (auto m = mirrors.begin(); m != mirrors.end(); )
+    {
+    if (m->second.generation != generation)
+      {
+      ren->RemoveViewProp(m->second.prop);
+      m = mirrors.erase(m);
+      }
+    else
+      {
+      ++m;
+      }
+    }
+
+  ren->ResetCameraClippingRange();
+}
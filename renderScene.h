@@ -0,0 +1,180 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: renderScene.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __RENDERSCENE_H__
+#define __RENDERSCENE_H__
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+// C++ includes
+#include <map>
+#include <string>
+#include <vector>
+
+// VTK forward declaration
+class vtkDataObject;
+class vtkMatrix4x4;
+class vtkObject;
+class vtkProp;
+class vtkRenderer;
+class vtkScalarsToColors;
+class vtkTextProperty;
+class vtkVolumeProperty;
+
+//! the state of one prop of the GUI renderer
+struct renderPropState
+  {
+  enum propType { enPolyDataActor = 0, enVolume, enLogo, enText };
+
+  const void                          *source = nullptr;  // the GUI prop; a key only, never dereferenced
+  propType                            type = enPolyDataActor;
+  bool                                visible = true;
+  double                              matrix[16];         // prop to world, row-major
+  vtkSmartPointer<vtkDataObject>      data;               // private copy, never modified once captured
+
+  // enPolyDataActor
+  double                              color[3] = { 1.0, 1.0, 1.0 };
+  double                              opacity = 1.0, lineWidth = 1.0, pointSize = 1.0, specular = 0.0;
+  bool                                lighting = true, scalarVisibility = false;
+  double                              scalarRange[2] = { 0.0, 1.0 };
+  vtkSmartPointer<vtkScalarsToColors> lookupTable;        // private copy, set if scalarVisibility
+
+  // enVolume
+  vtkSmartPointer<vtkVolumeProperty>  volumeProperty;     // private copy
+
+  // enLogo: normalized viewport position and size; enText: position in positionCoordinates
+  double                              position[2] = { 0.0, 0.0 }, position2[2] = { 0.0, 0.0 };
+
+  // enText
+  std::string                         text;
+  int                                 positionCoordinates = 0;
+  vtkSmartPointer<vtkTextProperty>    textProperty;       // private copy
+  };
+
+//! everything needed to render one frame of the scene
+struct renderSceneState
+  {
+  int                           width = 0, height = 0;
+  double                        background[3] = { 0.0, 0.0, 0.0 };
+  double                        cameraPosition[3], cameraFocalPoint[3], cameraViewUp[3];
+  double                        cameraViewAngle = 30.0, cameraParallelScale = 1.0;
+  bool                          cameraParallel = false;
+  std::vector<renderPropState>  props;
+  };
+
+/*!
+* GUI side: snapshots a vtkRenderer (camera, actors with polydata mappers,
+* volumes, logo representations, text actors) into a renderSceneState.
+*
+* Data sets, lookup tables and volume properties are deep-copied, but only when their MTime
+* has changed since the previous capture; unchanged data is shared with the
+* earlier snapshots. The copies are never modified afterwards, so another
+* thread may render them while the GUI keeps editing the originals.
+*
+* Image data is the exception: it is shallow-copied, so the snapshot shares the
+* scalar array with the GUI image. Code updating an image must therefore hand
+* over a new array rather than write into the current one; AllocateScalars()
+* does so whenever the array is still referenced by a snapshot.
+*/
+class renderSceneCapture
+{
+public:
+  //! snapshot ren, to be rendered at width x height pixels
+  void capture(vtkRenderer *ren, int width, int height, renderSceneState &state);
+
+  //! drop all cached copies
+  void clear() { copies.clear(); }
+
+private:
+  struct cachedCopy
+    {
+    vtkMTimeType              mtime = 0;
+    unsigned long             generation = 0;
+    vtkSmartPointer<vtkObject> copy;
+    };
+
+  vtkDataObject *copyOf(vtkDataObject *src);
+  vtkVolumeProperty *copyOf(vtkVolumeProperty *src);
+  vtkScalarsToColors *copyOf(vtkScalarsToColors *src);
+  vtkTextProperty *copyOf(vtkTextProperty *src);
+  cachedCopy &lookup(vtkObject *src);
+
+  std::map<const vtkObject *, cachedCopy>  copies;
+  unsigned long                           generation = 0;
+};
+
+/*!
+* Render side: keeps a renderer of its own in sync with the snapshots, creating
+* and removing mirror props as props appear in and disappear from the scene.
+* Must be used from the thread that renders.
+*/
+class renderSceneMirror
+{
+public:
+  ~renderSceneMirror();
+
+  void apply(const renderSceneState &state, vtkRenderer *ren);
+
+  //! remove all mirror props from the renderer they were added to
+  void clear();
+
+private:
+  struct mirrorProp
+    {
+    vtkSmartPointer<vtkProp>      prop;
+    vtkSmartPointer<vtkMatrix4x4> matrix;
+    renderPropState::propType     type = renderPropState::enPolyDataActor;
+    unsigned long                 generation = 0;
+    };
+
+  std::map<const void *, mirrorProp>  mirrors;
+  vtkSmartPointer<vtkRenderer>        renderer;
+  unsigned long                       generation = 0;
+};
+
+#endif // of __RENDERSCENE_H__
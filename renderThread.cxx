@@ -0,0 +1,184 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: renderThread.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "renderThread.h"
+#include "traceRecorder.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkUnsignedCharArray.h>
+
+// C++ includes
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+
+renderThread::renderThread(QObject *parent)
+  : QThread(parent), hasPending(false), stopping(false), frameSignalled(false)
+{
+}
+
+
+renderThread::~renderThread()
+{
+  this->stop();
+}
+
+
+void renderThread::submit(renderSceneState &state)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (hasPending)
+      stats.snapshotsDropped++;
+    std::swap(pending, state);
+    hasPending = true;
+  }
+  changed.notify_one();
+}
+
+
+void renderThread::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  changed.notify_one();
+  this->wait();
+}
+
+
+QImage renderThread::takeFrame()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  frameSignalled = false;
+  return latestFrame;
+}
+
+
+renderThread::statistics renderThread::getStatistics()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+
+void renderThread::run()
+{
+  traceRecorder::setThreadName("render thread");
+
+  // the window, and with it the GL context, is created and used on this thread only
+  vtkNew<vtkRenderer> ren;
+  vtkNew<vtkRenderWindow> renWin;
+  renWin->SetOffScreenRendering(1);
+  renWin->SwapBuffersOff(); // frames are read back from the back buffer
+  renWin->AddRenderer(ren);
+  vtkNew<vtkUnsignedCharArray> pixels;
+  renderSceneMirror mirror;
+
+  for (;;)
+    {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [this] { return hasPending || stopping; });
+      if (stopping)
+        break;
+      std::swap(pending, front);
+      hasPending = false;
+    }
+
+    const int w = front.width, h = front.height;
+    if (w <= 0 || h <= 0)
+      continue;
+
+    AIGS_TRACE_SCOPE("renderThread::frame");
+    auto t0 = std::chrono::steady_clock::now();
+
+    int *size = renWin->GetSize();
+    if (size[0] != w || size[1] != h)
+      renWin->SetSize(w, h);
+    mirror.apply(front, ren);
+    {
+      AIGS_TRACE_SCOPE("vtkRenderWindow::Render");
+      renWin->Render();
+    }
+    {
+      AIGS_TRACE_SCOPE("vtkRenderWindow::GetRGBACharPixelData");
+      renWin->GetRGBACharPixelData(0, 0, w - 1, h - 1, 0, pixels);
+    }
+
+    // VTK rows are bottom-up
+    QImage frame(w, h, QImage::Format_RGBA8888);
+    const unsigned char *src = pixels->GetPointer(0);
+    for (int y = 0; y < h; y++)
+      std::memcpy(frame.scanLine(h - 1 - y), src + (size_t)4 * w * y, (size_t)4 * w);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    bool notify;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      latestFrame = frame;
+      notify = !frameSignalled;
+      frameSignalled = true;
+
+      stats.framesRendered++;
+      stats.lastFrameMs = ms;
+      stats.meanFrameMs += (ms - stats.meanFrameMs) / stats.framesRendered;
+    }
+    if (notify)
+      emit frameReady();
+    }
+
+  // release the GL resources while the context is current on this thread
+  renWin->Finalize();
+  mirror.clear();
+  front = renderSceneState();
+}
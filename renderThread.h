@@ -0,0 +1,117 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: renderThread.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __RENDERTHREAD_H__
+#define __RENDERTHREAD_H__
+
+#pragma once
+
+// local includes
+#include "renderScene.h"
+
+// C++ includes
+#include <condition_variable>
+#include <mutex>
+
+// Qt includes
+#include <QImage>
+#include <QThread>
+
+/*!
+* Renders the scene on a thread of its own, so that slow frames (e.g. large
+* volumes) do not block the Qt event loop.
+*
+* The thread creates and owns an offscreen vtkRenderWindow, and with it the
+* OpenGL context. The GUI hands scene snapshots over with submit(): the
+* snapshot is swapped into a pending slot, and the render thread swaps the
+* pending slot with the one it renders from. A snapshot submitted while the
+* previous one is still pending replaces it, so the thread always renders the
+* latest state and never falls behind. Likewise only the latest frame is kept
+* for the GUI: frameReady() is emitted when a new frame is available and the
+* GUI picks it up with takeFrame().
+*/
+class renderThread : public QThread
+{
+  Q_OBJECT
+
+public:
+  struct statistics
+    {
+    long long framesRendered = 0;
+    long long snapshotsDropped = 0;   // replaced before they were rendered
+    double    lastFrameMs = 0.0;      // apply + render + read back
+    double    meanFrameMs = 0.0;
+    };
+
+  renderThread(QObject *parent = nullptr);
+  ~renderThread();
+
+  //! hand state over to the render thread; state receives a recycled snapshot to refill
+  void submit(renderSceneState &state);
+
+  //! stop rendering and wait for the thread to finish
+  void stop();
+
+  //! the latest rendered frame
+  QImage takeFrame();
+
+  statistics getStatistics();
+
+signals:
+  void frameReady();
+
+protected:
+  void run() override;
+
+private:
+  std::mutex              mutex;
+  std::condition_variable changed;
+  renderSceneState        pending, front;
+  bool                    hasPending, stopping, frameSignalled;
+  QImage                  latestFrame;
+  statistics              stats;
+};
+
+#endif // of __RENDERTHREAD_H__
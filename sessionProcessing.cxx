@@ -0,0 +1,277 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: sessionProcessing.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "landmarkRegistration.h"
+#include "pivotCalibration.h"
+#include "sessionProcessing.h"
+
+// VTK includes
+#include <vtkDirectory.h>
+#include <vtkNew.h>
+#include <vtksys/SystemTools.hxx>
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+// landmarkRegistration() takes the fiducials as interleaved xyz
+static_assert(sizeof(pointType) == 3 * sizeof(double), "pointType must be 3 packed doubles");
+
+
+namespace
+{
+// read fixed-size records of numbers, one per line
+template< size_t N > bool readRecords(const std::string &fname, std::vector< std::array<double, N> > &records)
+{
+  std::ifstream is(fname.c_str());
+  if (!is)
+    return false;
+
+  records.clear();
+  std::string line;
+  while (std::getline(is, line))
+    {
+    std::string::size_type first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#')
+      continue;
+
+    // accept space, tab or comma separated values
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream ls(line);
+    std::array<double, N> r;
+    for (size_t i = 0; i < N; i++)
+      {
+      if (!(ls >> r[i]))
+        return false;
+      }
+    records.push_back(r);
+    }
+
+  return true;
+}
+
+
+bool isSession(const std::string &dir)
+{
+  return vtksys::SystemTools::FileExists(dir + "/pivot.txt", true);
+}
+
+
+double elapsedSince(std::chrono::steady_clock::time_point t0)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+} // namespace
+
+
+bool readPoseFile(const std::string &fname, std::vector<poseType> &poses)
+{
+  return readRecords(fname, poses);
+}
+
+
+bool readPointFile(const std::string &fname, std::vector<pointType> &pts)
+{
+  return readRecords(fname, pts);
+}
+
+
+sessionResult processSession(const std::string &dir, const std::vector<pointType> &defaultFiducials)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  sessionResult result;
+  result.name = vtksys::SystemTools::GetFilenameName(dir);
+
+  //
+  // pivot calibration
+  //
+  std::vector<poseType> poses;
+  if (!readPoseFile(dir + "/pivot.txt", poses))
+    {
+    result.message = "cannot read pivot.txt";
+    result.elapsedMs = elapsedSince(t0);
+    return result;
+    }
+
+  pivotCalibration pivot;
+  for (const poseType &m : poses)
+    pivot.addPose(m.data());
+  result.numPivotPoses = pivot.getNumberOfPoses();
+  result.pivotRMS = pivot.solve(result.tip, result.pivot);
+  if (result.pivotRMS < 0.0)
+    {
+    result.message = "pivot calibration failed";
+    result.elapsedMs = elapsedSince(t0);
+    return result;
+    }
+
+  //
+  // fiducial registration: the model fiducials are the source, the digitized ones the target
+  //
+  std::vector<pointType> model, measured;
+  if (vtksys::SystemTools::FileExists(dir + "/fiducials.xyz", true))
+    {
+    if (!readPointFile(dir + "/fiducials.xyz", model))
+      {
+      result.message = "cannot read fiducials.xyz";
+      result.elapsedMs = elapsedSince(t0);
+      return result;
+      }
+    }
+  else
+    {
+    model = defaultFiducials;
+    }
+
+  if (vtksys::SystemTools::FileExists(dir + "/collected.txt", true))
+    {
+    // stylus tip = pose * calibrated tip offset
+    std::vector<poseType> collected;
+    if (!readPoseFile(dir + "/collected.txt", collected))
+      {
+      result.message = "cannot read collected.txt";
+      result.elapsedMs = elapsedSince(t0);
+      return result;
+      }
+    for (const poseType &m : collected)
+      {
+      pointType p;
+      for (int r = 0; r < 3; r++)
+        p[r] = m[4 * r] * result.tip[0] + m[4 * r + 1] * result.tip[1] + m[4 * r + 2] * result.tip[2] + m[4 * r + 3];
+      measured.push_back(p);
+      }
+    }
+  else if (vtksys::SystemTools::FileExists(dir + "/collected.xyz", true))
+    {
+    if (!readPointFile(dir + "/collected.xyz", measured))
+      {
+      result.message = "cannot read collected.xyz";
+      result.elapsedMs = elapsedSince(t0);
+      return result;
+      }
+    }
+
+  if (model.empty() && measured.empty())
+    {
+    // pivot calibration only
+    result.ok = true;
+    result.message = "no fiducials, registration skipped";
+    result.elapsedMs = elapsedSince(t0);
+    return result;
+    }
+
+  if (model.size() != measured.size())
+    {
+    std::ostringstream msg;
+    msg << model.size() << " model fiducials but " << measured.size() << " collected";
+    result.message = msg.str();
+    result.elapsedMs = elapsedSince(t0);
+    return result;
+    }
+
+  result.numFiducials = (int)model.size();
+  result.FRE = landmarkRegistration(model[0].data(), measured[0].data(), result.numFiducials,
+    result.registration);
+  result.ok = (result.FRE >= 0.0);
+  if (!result.ok)
+    result.message = "registration needs at least 3 fiducials";
+
+  result.elapsedMs = elapsedSince(t0);
+  return result;
+}
+
+
+std::vector<std::string> findSessions(const std::string &root)
+{
+  std::vector<std::string> sessions;
+
+  if (isSession(root))
+    {
+    sessions.push_back(root);
+    return sessions;
+    }
+
+  vtkNew<vtkDirectory> directory;
+  if (!directory->Open(root.c_str()))
+    return sessions;
+
+  for (vtkIdType i = 0; i < directory->GetNumberOfFiles(); i++)
+    {
+    std::string name = directory->GetFile(i);
+    if (name == "." || name == "..")
+      continue;
+
+    std::string path = root + "/" + name;
+    if (directory->FileIsDirectory(name.c_str()) && isSession(path))
+      sessions.push_back(path);
+    }
+
+  std::sort(sessions.begin(), sessions.end());
+  return sessions;
+}
+
+
+void writeSessionReport(std::ostream &os, const std::vector<sessionResult> &results)
+{
+  os << "session,status,pivot_poses,pivot_rms_mm,tip_x,tip_y,tip_z,pivot_x,pivot_y,pivot_z,"
+    "fiducials,fre_mm,time_ms,message\n";
+  os << std::fixed << std::setprecision(4);
+
+  for (const sessionResult &r : results)
+    {
+    os << r.name << "," << (r.ok ? "ok" : "failed") << ","
+      << r.numPivotPoses << "," << r.pivotRMS << ","
+      << r.tip[0] << "," << r.tip[1] << "," << r.tip[2] << ","
+      << r.pivot[0] << "," << r.pivot[1] << "," << r.pivot[2] << ","
+      << r.numFiducials << "," << r.FRE << "," << r.elapsedMs << ","
+      << "\"" << r.message << "\"\n";
+    }
+}
@@ -0,0 +1,110 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: sessionProcessing.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __SESSIONPROCESSING_H__
+#define __SESSIONPROCESSING_H__
+
+#pragma once
+
+// C++ includes
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*!
+* A recorded session is a directory holding
+*
+*   pivot.txt       stylus poses recorded during pivot calibration
+*   collected.txt   stylus poses recorded at each fiducial, or
+*   collected.xyz   the digitized fiducial positions themselves
+*   fiducials.xyz   the model fiducials (same format as File->Load Fiducial)
+*
+* Pose files hold one row-major 4x4 matrix per line (16 numbers); .xyz files
+* hold one point per line. Blank lines and lines starting with '#' are ignored.
+*/
+typedef std::array<double, 16> poseType;
+typedef std::array<double, 3>  pointType;
+
+//! outcome of processing one session
+struct sessionResult
+  {
+  std::string name;
+  bool        ok = false;
+  std::string message;
+
+  int         numPivotPoses = 0;
+  double      pivotRMS = -1.0;
+  double      tip[3] = { 0.0, 0.0, 0.0 };
+  double      pivot[3] = { 0.0, 0.0, 0.0 };
+
+  int         numFiducials = 0;
+  double      FRE = -1.0;
+  double      registration[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+  double      elapsedMs = 0.0;
+  };
+
+//! read a pose file. Returns false if the file cannot be opened or a line is malformed.
+bool readPoseFile(const std::string &fname, std::vector<poseType> &poses);
+
+//! read an .xyz point file. Returns false if the file cannot be opened or a line is malformed.
+bool readPointFile(const std::string &fname, std::vector<pointType> &pts);
+
+/*!
+* Run pivot calibration and fiducial registration on one session directory.
+*
+* defaultFiducials is used when the session has no fiducials.xyz of its own;
+* it may be empty.
+*/
+sessionResult processSession(const std::string &dir, const std::vector<pointType> &defaultFiducials);
+
+//! session directories below root, sorted by name. root itself if it is a session.
+std::vector<std::string> findSessions(const std::string &root);
+
+//! CSV summary, one line per session
+void writeSessionReport(std::ostream &os, const std::vector<sessionResult> &results);
+
+#endif // of __SESSIONPROCESSING_H__
@@ -0,0 +1,204 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: threadPool.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "threadPool.h"
+#include "traceRecorder.h"
+
+// C++ includes
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+
+threadPool::threadPool(int numThreads) : numBusy(0), stopping(false)
+{
+  if (numThreads <= 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  workers.reserve(numThreads);
+  for (int i = 0; i < numThreads; i++)
+    workers.emplace_back(&threadPool::workerLoop, this);
+}
+
+
+threadPool::~threadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  taskAvailable.notify_all();
+
+  for (std::thread &t : workers)
+    t.join();
+}
+
+
+void threadPool::enqueue(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+  taskAvailable.notify_one();
+}
+
+
+void threadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  allDone.wait(lock, [this] { return tasks.empty() && numBusy == 0; });
+}
+
+
+void threadPool::parallelFor(size_t n, const std::function<void(size_t, size_t)> &body, size_t grain)
+{
+  if (n == 0)
+    return;
+  grain = std::max<size_t>(1, grain);
+
+  // shared between the caller and the chunk runners
+  struct forState
+    {
+    std::atomic<size_t>     next;
+    size_t                  remaining;  // chunks neither finished nor abandoned
+    std::exception_ptr      error;      // the first exception thrown by body
+    std::mutex              mutex;
+    std::condition_variable done;
+    };
+  std::shared_ptr<forState> state = std::make_shared<forState>();
+  state->next = 0;
+
+  const size_t numChunks = (n + grain - 1) / grain;
+  state->remaining = numChunks;
+
+  // claim and run chunks until none are left. body is only touched for a
+  // claimed chunk, and the caller does not return before every claimed chunk
+  // is done, so runners that start late never see a dangling body.
+  auto runChunks = [n, grain, numChunks, &body](forState &s)
+    {
+    for (;;)
+      {
+      size_t begin = s.next.fetch_add(grain);
+      if (begin >= n)
+        return;
+
+      // the chunk counts as done however body() leaves
+      struct chunkGuard
+        {
+        forState  &s;
+        size_t    count;
+        ~chunkGuard()
+          {
+          std::lock_guard<std::mutex> lock(s.mutex);
+          s.remaining -= count;
+          if (s.remaining == 0)
+            s.done.notify_all();
+          }
+        } guard = { s, 1 };
+
+      try
+        {
+        body(begin, std::min(n, begin + grain));
+        }
+      catch (...)
+        {
+        // abandon the chunks nobody has claimed yet
+        size_t stop = s.next.fetch_add(n);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.error)
+          s.error = std::current_exception();
+        if (stop < n)
+          guard.count += numChunks - stop / grain;
+        }
+      }
+    };
+
+  // the caller takes chunks too, so the loop progresses even if every worker
+  // is busy with another caller's work
+  int numRunners = (int)std::min<size_t>(numChunks - 1, workers.size());
+  for (int r = 0; r < numRunners; r++)
+    this->enqueue([state, runChunks]() { runChunks(*state); });
+
+  runChunks(*state);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->done.wait(lock, [&state] { return state->remaining == 0; });
+  if (state->error)
+    std::rethrow_exception(state->error);
+}
+
+
+void threadPool::workerLoop()
+{
+  traceRecorder::setThreadName("threadPool worker");
+  for (;;)
+    {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (stopping && tasks.empty())
+        return;
+      task = std::move(tasks.front());
+      tasks.pop_front();
+      numBusy++;
+    }
+
+    {
+      AIGS_TRACE_SCOPE("threadPool::task");
+      task();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      numBusy--;
+      if (tasks.empty() && numBusy == 0)
+        allDone.notify_all();
+    }
+    }
+}
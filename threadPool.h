@@ -0,0 +1,106 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: threadPool.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#pragma once
+
+// C++ includes
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+* A fixed-size pool of worker threads.
+*
+* Tasks are run in FIFO order. parallelFor() splits an index range into chunks
+* that the workers pull from a shared counter, so uneven work items balance
+* themselves. Neither enqueue() nor parallelFor() may be called from within a
+* task running on the same pool, but several threads outside the pool may
+* call parallelFor() at the same time, so one pool can be shared.
+*/
+class threadPool
+{
+public:
+  //! numThreads <= 0 uses one thread per hardware core
+  explicit threadPool(int numThreads = 0);
+  ~threadPool();
+
+  int getNumberOfThreads() const { return (int)workers.size(); }
+
+  //! queue a task for asynchronous execution
+  void enqueue(std::function<void()> task);
+
+  //! block until every queued task has finished
+  void wait();
+
+  /*!
+  * Call body(begin, end) over [0, n) in chunks of at most grain items and
+  * block until all chunks are done. The calling thread runs chunks as well.
+  * If body throws, the chunks not yet started are skipped and the first
+  * exception is rethrown once the running chunks have finished.
+  */
+  void parallelFor(size_t n, const std::function<void(size_t, size_t)> &body, size_t grain = 1);
+
+private:
+  threadPool(const threadPool &) = delete;
+  threadPool &operator=(const threadPool &) = delete;
+
+  void workerLoop();
+
+  std::vector<std::thread>            workers;
+  std::deque< std::function<void()> > tasks;
+  std::mutex                          mutex;
+  std::condition_variable             taskAvailable, allDone;
+  int                                 numBusy;
+  bool                                stopping;
+};
+
+#endif // of __THREADPOOL_H__
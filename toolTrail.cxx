@@ -0,0 +1,332 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: toolTrail.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "toolTrail.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+
+
+toolTrail::toolTrail(int headCap, int fullResChunks, int archiveCap, int maxArch)
+{
+  headCapacity = std::max(headCap, 2);
+  fullResolutionChunks = std::max(fullResChunks, 0);
+  archiveCapacity = std::max(archiveCap, headCapacity);
+  maxArchives = std::max(maxArch, 1);
+  timeWindow = 0.0;
+  tolerance = 0.5;
+
+  // the head, the sealed chunks, the archives, and one spare for the hand-over
+  slots.resize(2 + fullResolutionChunks + maxArchives);
+  for (chunk &c : slots)
+    {
+    c.data = vtkSmartPointer<vtkPolyData>::New();
+    c.points = vtkSmartPointer<vtkPoints>::New();
+    c.points->SetDataTypeToFloat();
+    c.lines = vtkSmartPointer<vtkCellArray>::New();
+    c.data->SetPoints(c.points);
+    c.data->SetLines(c.lines);
+    }
+  this->clear();
+}
+
+
+void toolTrail::clear()
+{
+  freeSlots.clear();
+  for (int s = (int)slots.size() - 1; s >= 0; s--)
+    this->releaseSlot(s);
+  head = -1;
+  sealed.clear();
+  archives.clear();
+  broken = true;
+  hasLastPoint = false;
+  lastTime = 0.0;
+  stats = statistics();
+}
+
+
+int toolTrail::takeSlot()
+{
+  int s = freeSlots.back();
+  freeSlots.pop_back();
+  return s;
+}
+
+
+void toolTrail::releaseSlot(int s)
+{
+  chunk &c = slots[s];
+  c.points->Reset();
+  c.times.clear();
+  c.runStarts.clear();
+  c.first = 0;
+  c.continuesPrevious = false;
+  c.modified = true;
+  c.pointsChanged = true;
+  freeSlots.push_back(s);
+}
+
+
+void toolTrail::addPoint(double t, const double position[3])
+{
+  if (head >= 0 && (int)slots[head].times.size() >= headCapacity)
+    this->sealHead();
+
+  if (head < 0)
+    {
+    head = this->takeSlot();
+    slots[head].points->Allocate(headCapacity);
+
+    // repeat the last point, so that the polyline goes on across chunks
+    if (!broken && hasLastPoint)
+      {
+      chunk &h = slots[head];
+      h.points->InsertNextPoint(lastPoint);
+      h.times.push_back(lastTime);
+      h.runStarts.push_back(0);
+      h.continuesPrevious = true;
+      }
+    }
+
+  chunk &h = slots[head];
+  if (broken || h.runStarts.empty())
+    h.runStarts.push_back((vtkIdType)h.times.size());
+  h.points->InsertNextPoint(position);
+  h.times.push_back(t);
+  h.modified = true;
+  h.pointsChanged = true;
+
+  std::copy(position, position + 3, lastPoint);
+  lastTime = t;
+  hasLastPoint = true;
+  broken = false;
+  stats.numSamples++;
+}
+
+
+void toolTrail::breakTrail()
+{
+  broken = true;
+}
+
+
+void toolTrail::sealHead()
+{
+  sealed.push_back(head);
+  head = -1;
+
+  if ((int)sealed.size() > fullResolutionChunks)
+    {
+    int s = sealed.front();
+    sealed.pop_front();
+    this->archive(s);
+    this->releaseSlot(s);
+    }
+}
+
+
+void toolTrail::archive(int s)
+{
+  const chunk &c = slots[s];
+
+  // radial decimation of each polyline: keep its ends, and the points at least
+  // tolerance away from the previous kept point
+  std::vector<vtkIdType> keep;
+  std::vector<char> startsRun;
+  vtkIdType n = (vtkIdType)c.times.size();
+  double tol2 = tolerance * tolerance;
+  for (size_t r = 0; r < c.runStarts.size(); r++)
+    {
+    vtkIdType begin = std::max(c.runStarts[r], c.first);
+    vtkIdType end = (r + 1 < c.runStarts.size()) ? c.runStarts[r + 1] : n;
+    if (begin >= end)
+      continue;
+
+    double kept[3], p[3];
+    c.points->GetPoint(begin, kept);
+    keep.push_back(begin);
+    startsRun.push_back(1);
+    for (vtkIdType i = begin + 1; i < end; i++)
+      {
+      c.points->GetPoint(i, p);
+      double d2 = (p[0] - kept[0]) * (p[0] - kept[0]) + (p[1] - kept[1]) * (p[1] - kept[1]) +
+        (p[2] - kept[2]) * (p[2] - kept[2]);
+      if (d2 >= tol2 || i == end - 1)
+        {
+        keep.push_back(i);
+        startsRun.push_back(0);
+        std::copy(p, p + 3, kept);
+        }
+      }
+    }
+  if (keep.empty())
+    return;
+
+  // open a new archive when the current one is full, dropping the oldest
+  if (archives.empty() || slots[archives.back()].times.size() + keep.size() > (size_t)archiveCapacity)
+    {
+    if ((int)archives.size() >= maxArchives)
+      {
+      this->releaseSlot(archives.front());
+      archives.pop_front();
+      }
+    archives.push_back(this->takeSlot());
+    }
+  chunk &a = slots[archives.back()];
+
+  // the first point of a continuing chunk is the last point of the archive
+  bool continues = c.continuesPrevious && keep[0] == 0 && !a.times.empty();
+  double p[3];
+  for (size_t k = (continues ? 1 : 0); k < keep.size(); k++)
+    {
+    if (startsRun[k])
+      a.runStarts.push_back((vtkIdType)a.times.size());
+    c.points->GetPoint(keep[k], p);
+    a.points->InsertNextPoint(p);
+    a.times.push_back(c.times[keep[k]]);
+    }
+  a.modified = true;
+  a.pointsChanged = true;
+}
+
+
+void toolTrail::expire(double cutoff)
+{
+  // true if the whole chunk is older than cutoff; otherwise hide its older points
+  auto trim = [this, cutoff](int s) -> bool
+    {
+    chunk &c = slots[s];
+    if (c.times.empty() || c.times.back() < cutoff)
+      return true;
+    vtkIdType f = (vtkIdType)(std::lower_bound(c.times.begin(), c.times.end(), cutoff) - c.times.begin());
+    if (f > c.first)
+      {
+      c.first = f;
+      c.modified = true;
+      }
+    return false;
+    };
+
+  // chunks are in time order: stop at the first one that is not entirely expired
+  while (!archives.empty())
+    {
+    if (!trim(archives.front()))
+      return;
+    this->releaseSlot(archives.front());
+    archives.pop_front();
+    }
+  while (!sealed.empty())
+    {
+    if (!trim(sealed.front()))
+      return;
+    this->releaseSlot(sealed.front());
+    sealed.pop_front();
+    }
+  if (head >= 0 && trim(head))
+    {
+    this->releaseSlot(head);
+    head = -1;
+    broken = true;
+    }
+}
+
+
+void toolTrail::rebuildLines(chunk &c)
+{
+  c.lines->Reset();
+  vtkIdType n = (vtkIdType)c.times.size();
+  for (size_t r = 0; r < c.runStarts.size(); r++)
+    {
+    vtkIdType begin = std::max(c.runStarts[r], c.first);
+    vtkIdType end = (r + 1 < c.runStarts.size()) ? c.runStarts[r + 1] : n;
+    if (end - begin < 2)
+      continue;
+    c.lines->InsertNextCell((int)(end - begin));
+    for (vtkIdType i = begin; i < end; i++)
+      c.lines->InsertCellPoint(i);
+    }
+  // the polydata MTime follows those of its points and cells
+  c.lines->Modified();
+  if (c.pointsChanged)
+    c.points->Modified();
+  c.pointsChanged = false;
+}
+
+
+void toolTrail::update(double now)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  if (timeWindow > 0.0)
+    this->expire(now - timeWindow);
+
+  stats.modifiedChunks = 0;
+  stats.numPoints = 0;
+  stats.numChunks = 0;
+  for (chunk &c : slots)
+    {
+    if (c.modified)
+      {
+      this->rebuildLines(c);
+      c.modified = false;
+      stats.modifiedChunks++;
+      }
+    if (!c.times.empty())
+      {
+      stats.numChunks++;
+      stats.numPoints += (long long)c.times.size() - c.first;
+      }
+    }
+
+  stats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
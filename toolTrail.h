@@ -0,0 +1,158 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: toolTrail.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __TOOLTRAIL_H__
+#define __TOOLTRAIL_H__
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+// C++ includes
+#include <deque>
+#include <vector>
+
+// VTK forward declaration
+class vtkCellArray;
+class vtkPoints;
+class vtkPolyData;
+
+/*!
+* Trajectory of a tool tip over the last N seconds or the whole case, with a
+* per-sample cost that does not depend on the length of the trail.
+*
+* The samples go into fixed-capacity chunks, each a polydata of its own with
+* polylines. Only the head chunk takes new samples. Once full, it is sealed
+* and never modified again, so its buffers are uploaded once. Sealed chunks
+* older than the last few are decimated and merged into archive chunks. The
+* archives form a ring that drops the oldest one when full, which bounds the
+* memory.
+*
+* The chunks live in a fixed pool (getNumberOfSlots()), so a renderer can
+* create one actor per slot once; unused slots hold empty polydata. Each
+* update() touches at most the head chunk, the chunk trimmed by the time
+* window, and, once per sealed chunk, the archive it is merged into. Trimming
+* only rebuilds the polylines of a chunk: its points are left unmodified.
+*/
+class toolTrail
+{
+public:
+  struct statistics
+    {
+    long long numSamples = 0;       // added since the last clear()
+    long long numPoints = 0;        // currently in the trail
+    int       numChunks = 0;        // slots in use
+    int       modifiedChunks = 0;   // by the last update()
+    double    updateMs = 0.0;       // last update()
+    };
+
+  /*!
+  * headCapacity: points per full-resolution chunk; fullResolutionChunks:
+  * sealed chunks kept before decimation; archiveCapacity and maxArchives:
+  * size of the decimated history.
+  */
+  toolTrail(int headCapacity = 1024, int fullResolutionChunks = 8, int archiveCapacity = 65536,
+    int maxArchives = 32);
+
+  //! keep only the samples of the last seconds; 0 keeps the whole case (default)
+  void setTimeWindow(double seconds) { timeWindow = seconds; }
+  double getTimeWindow() const { return timeWindow; }
+
+  //! archived points closer than this to the previous kept point are dropped (default 0.5 mm)
+  void setDecimationTolerance(double mm) { tolerance = mm; }
+
+  void clear();
+
+  //! a tip position at time t (seconds, increasing)
+  void addPoint(double t, const double position[3]);
+
+  //! the next point starts a new polyline (e.g. the tool was missing)
+  void breakTrail();
+
+  //! expire the samples older than the time window at time now, and update the modified chunks
+  void update(double now);
+
+  int getNumberOfSlots() const { return (int)slots.size(); }
+  vtkPolyData *getSlot(int i) const { return slots[i].data; }
+
+  const statistics &getStatistics() const { return stats; }
+
+private:
+  struct chunk
+    {
+    vtkSmartPointer<vtkPolyData>  data;
+    vtkSmartPointer<vtkPoints>    points;
+    vtkSmartPointer<vtkCellArray> lines;
+    std::vector<double>           times;
+    std::vector<vtkIdType>        runStarts;  // first point of each polyline
+    vtkIdType                     first;      // first point inside the time window
+    bool                          continuesPrevious; // first polyline continues the previous chunk
+    bool                          modified;   // the polylines must be rebuilt
+    bool                          pointsChanged; // points were added or removed since the last update
+    };
+
+  int  takeSlot();
+  void releaseSlot(int s);
+  void sealHead();
+  void archive(int s);
+  void expire(double cutoff);
+  void rebuildLines(chunk &c);
+
+  std::vector<chunk>  slots;
+  std::vector<int>    freeSlots;
+  int                 head;           // -1 if none
+  std::deque<int>     sealed;         // full resolution, oldest first
+  std::deque<int>     archives;       // decimated, oldest first; the last one is open
+
+  int                 headCapacity, fullResolutionChunks, archiveCapacity, maxArchives;
+  double              timeWindow, tolerance;
+  bool                broken;         // the next point starts a new polyline
+  double              lastPoint[3], lastTime;
+  bool                hasLastPoint;
+  statistics          stats;
+};
+
+#endif // of __TOOLTRAIL_H__
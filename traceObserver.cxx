@@ -0,0 +1,108 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: traceObserver.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "traceObserver.h"
+#include "traceRecorder.h"
+
+// VTK includes
+#include <vtkAbstractVolumeMapper.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCommand.h>
+#include <vtkNew.h>
+
+
+namespace
+{
+struct tracedEvents
+  {
+  unsigned long beginEvent;
+  const char    *name;
+  std::int64_t  begin;        // -1 outside a begin/end pair, or if not recording
+  };
+
+
+void onTracedEvent(vtkObject *, unsigned long eventId, void *clientData, void *)
+{
+  tracedEvents *events = static_cast<tracedEvents *>(clientData);
+  if (eventId == events->beginEvent)
+    {
+    events->begin = traceRecorder::isEnabled() ? traceRecorder::now() : -1;
+    return;
+    }
+
+  if (events->begin >= 0 && traceRecorder::isEnabled())
+    traceRecorder::record(events->name, events->begin, traceRecorder::now());
+  events->begin = -1;
+}
+
+
+void deleteTracedEvents(void *clientData)
+{
+  delete static_cast<tracedEvents *>(clientData);
+}
+} // namespace
+
+
+void traceVTKEvents(vtkObject *object, unsigned long beginEvent, unsigned long endEvent, const char *name)
+{
+  if (!object)
+    return;
+
+  vtkNew<vtkCallbackCommand> command;
+  command->SetCallback(onTracedEvent);
+  command->SetClientData(new tracedEvents{ beginEvent, name, -1 });
+  command->SetClientDataDeleteCallback(deleteTracedEvents);
+  object->AddObserver(beginEvent, command);
+  object->AddObserver(endEvent, command);
+}
+
+
+void traceVolumeMapper(vtkAbstractVolumeMapper *mapper)
+{
+  // vtkSmartVolumeMapper forwards these from the mapper it delegates to
+  traceVTKEvents(mapper, vtkCommand::VolumeMapperRenderStartEvent, vtkCommand::VolumeMapperRenderEndEvent,
+    "volumeMapper::Render");
+}
@@ -0,0 +1,251 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: traceRecorder.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "traceRecorder.h"
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <ios>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // relaxed atomics: plain stores on the recording thread, yet well defined
+  // when the export reads an event that is being overwritten
+  struct traceSlot
+    {
+    std::atomic<const char *>   name;
+    std::atomic<std::int64_t>   begin, end;
+    };
+
+  struct threadRing
+    {
+    int                           tid = 0;
+    std::string                   name;              // guarded by registryMutex
+    bool                          inUse = true;      // by a running thread; guarded by registryMutex
+    std::unique_ptr<traceSlot[]>  slots;             // allocated by the owner before the first head store
+    std::atomic<std::int64_t>     head{ 0 };         // events ever recorded; written by the owner only
+    std::atomic<std::int64_t>     clearedAt{ 0 };    // events before this one were cleared
+    };
+
+  std::mutex                                  registryMutex;
+  std::vector< std::unique_ptr<threadRing> >  registry;
+
+  // hands the ring of the thread back to the registry when the thread exits
+  struct ringOwner
+    {
+    threadRing *ring = nullptr;
+    ~ringOwner()
+      {
+      if (ring)
+        {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ring->inUse = false;
+        }
+      }
+    };
+  thread_local ringOwner                      localRing;
+
+  const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+  threadRing *getLocalRing()
+    {
+    if (!localRing.ring)
+      {
+      std::lock_guard<std::mutex> lock(registryMutex);
+
+      // reuse the ring of a thread that has exited: its events stay exportable
+      // until the new owner overwrites them, under the same tid
+      for (const std::unique_ptr<threadRing> &ring : registry)
+        {
+        if (!ring->inUse)
+          {
+          ring->inUse = true;
+          ring->name.clear();
+          localRing.ring = ring.get();
+          return localRing.ring;
+          }
+        }
+
+      std::unique_ptr<threadRing> ring(new threadRing);
+      ring->tid = (int)registry.size() + 1;
+      localRing.ring = ring.get();
+      registry.push_back(std::move(ring));
+      }
+    return localRing.ring;
+    }
+
+  void writeJSONString(std::ostream &os, const char *s)
+    {
+    os << '"';
+    for (; *s; s++)
+      {
+      if (*s == '"' || *s == '\\')
+        os << '\\' << *s;
+      else if ((unsigned char)*s >= 0x20)
+        os << *s;
+      }
+    os << '"';
+    }
+}
+
+
+std::atomic<bool> traceRecorder::recording(false);
+
+
+void traceRecorder::setEnabled(bool enabled)
+{
+  recording.store(enabled, std::memory_order_relaxed);
+}
+
+
+void traceRecorder::clear()
+{
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (const std::unique_ptr<threadRing> &ring : registry)
+    ring->clearedAt.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+
+void traceRecorder::setThreadName(const char *name)
+{
+  threadRing *ring = getLocalRing();
+  std::lock_guard<std::mutex> lock(registryMutex);
+  ring->name = name;
+}
+
+
+std::int64_t traceRecorder::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+
+void traceRecorder::record(const char *name, std::int64_t begin, std::int64_t end)
+{
+  threadRing *ring = getLocalRing();
+  if (!ring->slots)
+    ring->slots.reset(new traceSlot[eventsPerThread]);
+
+  std::int64_t h = ring->head.load(std::memory_order_relaxed);
+  // seqlock writer: a reader that sees any of the stores below also sees head
+  // at h or later, and so knows that event h - eventsPerThread is going
+  std::atomic_thread_fence(std::memory_order_release);
+  traceSlot &s = ring->slots[h & (eventsPerThread - 1)];
+  s.name.store(name, std::memory_order_relaxed);
+  s.begin.store(begin, std::memory_order_relaxed);
+  s.end.store(end, std::memory_order_relaxed);
+  ring->head.store(h + 1, std::memory_order_release);
+}
+
+
+long long traceRecorder::writeChromeTrace(std::ostream &os)
+{
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  long long numEvents = 0;
+  bool first = true;
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  auto separator = [&]()
+    {
+    os << (first ? "\n" : ",\n");
+    first = false;
+    };
+
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os.setf(std::ios::fixed, std::ios::floatfield);
+  os.precision(3);
+  for (const std::unique_ptr<threadRing> &ring : registry)
+    {
+    if (!ring->name.empty())
+      {
+      separator();
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid << ",\"args\":{\"name\":";
+      writeJSONString(os, ring->name.c_str());
+      os << "}}";
+      }
+
+    // copy the events, then drop those the owner may have overwritten meanwhile
+    std::int64_t head = ring->head.load(std::memory_order_acquire);
+    std::int64_t begin = std::max(ring->clearedAt.load(std::memory_order_relaxed), head - (std::int64_t)eventsPerThread);
+    if (head <= begin)
+      continue;
+    std::vector<const char *> names;
+    std::vector<std::int64_t> times;
+    for (std::int64_t i = begin; i < head; i++)
+      {
+      const traceSlot &s = ring->slots[i & (eventsPerThread - 1)];
+      names.push_back(s.name.load(std::memory_order_relaxed));
+      times.push_back(s.begin.load(std::memory_order_relaxed));
+      times.push_back(s.end.load(std::memory_order_relaxed));
+      }
+    // the owner overwrites event i while recording event i + eventsPerThread.
+    // The fence keeps the slot loads above before the head load (seqlock reader).
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::int64_t overwritten = ring->head.load(std::memory_order_relaxed) - (std::int64_t)eventsPerThread + 1;
+    for (std::int64_t i = std::max(begin, overwritten); i < head; i++)
+      {
+      size_t k = (size_t)(i - begin);
+      separator();
+      os << "{\"name\":";
+      writeJSONString(os, names[k]);
+      os << ",\"cat\":\"aigs\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid
+        << ",\"ts\":" << times[2 * k] * 1e-3 << ",\"dur\":" << (times[2 * k + 1] - times[2 * k]) * 1e-3 << "}";
+      numEvents++;
+      }
+    }
+
+  os << "\n]}\n";
+  os.flags(flags);
+  os.precision(precision);
+  return numEvents;
+}
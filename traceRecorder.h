@@ -0,0 +1,128 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: traceRecorder.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __TRACERECORDER_H__
+#define __TRACERECORDER_H__
+
+#pragma once
+
+// C++ includes
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+/*!
+* Scoped trace markers for the hot paths, exported as Chrome trace-event JSON
+* (chrome://tracing, Perfetto, Speedscope).
+*
+* Each thread records into a ring buffer of its own, allocated on its first
+* event, so the threads never share a lock or a cache line while recording;
+* the export reads the rings concurrently and keeps the newest
+* eventsPerThread events of each ring. When a thread exits, its ring is handed
+* over, events included, to the next thread that records, so the memory is
+* bounded by the number of threads running at the same time. When recording is
+* off, a marker costs one relaxed atomic load and a branch.
+*
+* Event names are stored as pointers: pass string literals only.
+*/
+class traceRecorder
+{
+public:
+  //! ring size per thread, in events (24 bytes each)
+  static const int eventsPerThread = 1 << 17;
+
+  static void setEnabled(bool enabled);
+  static bool isEnabled() { return recording.load(std::memory_order_relaxed); }
+
+  //! forget the events recorded so far, on all threads
+  static void clear();
+
+  //! name the calling thread in the exported trace
+  static void setThreadName(const char *name);
+
+  //! nanoseconds since the program started
+  static std::int64_t now();
+
+  //! a complete event of the calling thread, begin and end from now()
+  static void record(const char *name, std::int64_t begin, std::int64_t end);
+
+  //! write the recorded events as Chrome trace-event JSON; returns the number of events
+  static long long writeChromeTrace(std::ostream &os);
+
+private:
+  static std::atomic<bool> recording;
+};
+
+//! records the lifetime of the enclosing scope while the recorder is enabled
+class traceScope
+{
+public:
+  explicit traceScope(const char *eventName)
+    : name(traceRecorder::isEnabled() ? eventName : nullptr), begin(0)
+    {
+    if (name)
+      begin = traceRecorder::now();
+    }
+  ~traceScope()
+    {
+    if (name)
+      traceRecorder::record(name, begin, traceRecorder::now());
+    }
+
+private:
+  traceScope(const traceScope &) = delete;
+  traceScope &operator=(const traceScope &) = delete;
+
+  const char    *name;
+  std::int64_t  begin;
+};
+
+#define AIGS_TRACE_CONCAT_(a, b) a##b
+#define AIGS_TRACE_CONCAT(a, b) AIGS_TRACE_CONCAT_(a, b)
+
+//! trace the rest of the enclosing scope under name, a string literal
+#define AIGS_TRACE_SCOPE(name) traceScope AIGS_TRACE_CONCAT(aigsTraceScope, __LINE__)(name)
+
+#endif // of __TRACERECORDER_H__
@@ -0,0 +1,77 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: trackerStatusDrawing.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "trackerStatusDrawing.h"
+
+// VTK includes
+#include <vtkImageCanvasSource2D.h>
+
+
+void drawTrackerToolStatus(vtkImageCanvasSource2D *canvas, int i,
+  enumTrackerToolStatus status, int boxX, int boxY)
+{
+  switch (status)
+    {
+    case enToolMissing:
+      // not connected, shown in blue
+      canvas->SetDrawColor(0, 0, 255);
+      break;
+    case enToolOutOfVolume:
+      // connected, visible but not accurate, shown in yellow
+      canvas->SetDrawColor(255, 255, 0);
+      break;
+    case enToolOutOfView:
+      // connected, visible, but outside of the tracking volume. Shown in red
+      canvas->SetDrawColor(255, 0, 0);
+      break;
+    default:
+      // connected and withing good tracking accuracy. shown in green
+      canvas->SetDrawColor(0, 255, 0);
+      break;
+    }
+
+  canvas->FillBox(boxX*i + i + 1, boxX*(i + 1) + i, 1, boxY + 1);
+}
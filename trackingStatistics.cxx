@@ -0,0 +1,337 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: trackingStatistics.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "trackingStatistics.h"
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+
+
+const double toolStatistics::motionThreshold = 1.0;
+const double toolStatistics::rateBucketSeconds = 0.5;
+
+
+p2Quantile::p2Quantile(double quantile)
+  : p(quantile)
+{
+  this->reset();
+}
+
+
+void p2Quantile::reset()
+{
+  count = 0;
+  for (int i = 0; i < 5; i++)
+    {
+    q[i] = 0.0;
+    n[i] = i;
+    }
+  desired[0] = 0.0;
+  desired[1] = 2.0 * p;
+  desired[2] = 4.0 * p;
+  desired[3] = 2.0 + 2.0 * p;
+  desired[4] = 4.0;
+  increment[0] = 0.0;
+  increment[1] = p / 2.0;
+  increment[2] = p;
+  increment[3] = (1.0 + p) / 2.0;
+  increment[4] = 1.0;
+}
+
+
+void p2Quantile::add(double x)
+{
+  // the first five samples initialize the markers
+  if (count < 5)
+    {
+    q[count++] = x;
+    if (count == 5)
+      std::sort(q, q + 5);
+    return;
+    }
+  count++;
+
+  int k;
+  if (x < q[0])
+    {
+    q[0] = x;
+    k = 0;
+    }
+  else if (x >= q[4])
+    {
+    q[4] = x;
+    k = 3;
+    }
+  else
+    {
+    k = 0;
+    while (x >= q[k + 1])
+      k++;
+    }
+
+  for (int i = k + 1; i < 5; i++)
+    n[i] += 1.0;
+  for (int i = 0; i < 5; i++)
+    desired[i] += increment[i];
+
+  // move the middle markers towards their desired positions
+  for (int i = 1; i < 4; i++)
+    {
+    double d = desired[i] - n[i];
+    if ((d >= 1.0 && n[i + 1] - n[i] > 1.0) || (d <= -1.0 && n[i - 1] - n[i] < -1.0))
+      {
+      int s = d > 0.0 ? 1 : -1;
+      double parabolic = q[i] + s / (n[i + 1] - n[i - 1]) *
+        ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+        (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+      if (q[i - 1] < parabolic && parabolic < q[i + 1])
+        q[i] = parabolic;
+      else
+        q[i] += s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+      n[i] += s;
+      }
+    }
+}
+
+
+double p2Quantile::get() const
+{
+  if (count == 0)
+    return 0.0;
+
+  if (count < 5)
+    {
+    // insertion sort of the few samples seen so far
+    double sorted[5];
+    for (int i = 0; i < (int)count; i++)
+      {
+      int j = i;
+      for (; j > 0 && sorted[j - 1] > q[i]; j--)
+        sorted[j] = sorted[j - 1];
+      sorted[j] = q[i];
+      }
+    int idx = std::min((int)count - 1, (int)std::floor(p * count));
+    return sorted[idx];
+    }
+
+  return q[2];
+}
+
+
+toolStatistics::toolStatistics()
+  : intervalP50(0.5), intervalP95(0.95), intervalP99(0.99)
+{
+  this->reset();
+}
+
+
+void toolStatistics::reset()
+{
+  samples = dropouts = 0;
+  std::fill(statusCount, statusCount + enToolStatus_Max, 0);
+  lastStatus = enToolMissing;
+
+  std::fill(rateBuckets, rateBuckets + numRateBuckets, 0);
+  currentBucket = 0;
+  firstTime = lastTime = 0.0;
+
+  intervalP50.reset();
+  intervalP95.reset();
+  intervalP99.reset();
+
+  staticCount = 0;
+  pooledDegrees = 0;
+  pooledM2 = 0.0;
+}
+
+
+void toolStatistics::poolStaticPeriod()
+{
+  if (staticCount >= minStaticSamples)
+    {
+    pooledDegrees += staticCount - 1;
+    pooledM2 += staticM2[0] + staticM2[1] + staticM2[2];
+    }
+  staticCount = 0;
+}
+
+
+void toolStatistics::addSample(double t, enumTrackerToolStatus status, const double position[3])
+{
+  // sample rate
+  long long bucket = (long long)std::floor(t / rateBucketSeconds);
+  if (samples == 0)
+    {
+    firstTime = t;
+    currentBucket = bucket;
+    }
+  else
+    {
+    intervalP50.add(1000.0 * (t - lastTime));
+    intervalP95.add(1000.0 * (t - lastTime));
+    intervalP99.add(1000.0 * (t - lastTime));
+
+    // clear the buckets skipped since the last sample
+    for (long long b = currentBucket + 1; b <= bucket && b <= currentBucket + numRateBuckets; b++)
+      rateBuckets[b % numRateBuckets] = 0;
+    currentBucket = std::max(currentBucket, bucket);
+    }
+  rateBuckets[currentBucket % numRateBuckets]++;
+  lastTime = t;
+
+  // status counts
+  samples++;
+  statusCount[status]++;
+  if (lastStatus == enToolOK && status != enToolOK)
+    dropouts++;
+  lastStatus = status;
+
+  if (status != enToolOK)
+    {
+    this->poolStaticPeriod();
+    return;
+    }
+
+  // static jitter: restart when the tool moves away from the running mean
+  if (staticCount > 0)
+    {
+    double d2 = 0.0;
+    for (int i = 0; i < 3; i++)
+      d2 += (position[i] - staticMean[i]) * (position[i] - staticMean[i]);
+    if (d2 > motionThreshold * motionThreshold)
+      this->poolStaticPeriod();
+    }
+
+  if (staticCount == 0)
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      staticMean[i] = position[i];
+      staticM2[i] = 0.0;
+      }
+    staticCount = 1;
+    return;
+    }
+
+  staticCount++;
+  for (int i = 0; i < 3; i++)
+    {
+    double delta = position[i] - staticMean[i];
+    staticMean[i] += delta / staticCount;
+    staticM2[i] += delta * (position[i] - staticMean[i]);
+    }
+}
+
+
+toolStatistics::summary toolStatistics::getSummary(double now) const
+{
+  summary s;
+  s.samples = samples;
+  std::copy(statusCount, statusCount + enToolStatus_Max, s.statusCount);
+  s.dropouts = dropouts;
+
+  if (samples > 1)
+    {
+    // the buckets that have left the window since the last sample count as cleared
+    now = std::max(now, lastTime);
+    long long nowBucket = (long long)std::floor(now / rateBucketSeconds);
+    long long inWindow = 0;
+    for (long long b = std::max(currentBucket - numRateBuckets, nowBucket - numRateBuckets) + 1; b <= currentBucket; b++)
+      inWindow += rateBuckets[(b % numRateBuckets + numRateBuckets) % numRateBuckets];
+
+    // completed buckets plus the elapsed part of the current one, no longer than the recording
+    double span = (numRateBuckets - 1) * rateBucketSeconds + (now - nowBucket * rateBucketSeconds);
+    span = std::min(span, now - firstTime);
+    s.sampleRateHz = span > 0.0 ? inWindow / span : 0.0;
+    }
+
+  s.intervalP50Ms = intervalP50.get();
+  s.intervalP95Ms = intervalP95.get();
+  s.intervalP99Ms = intervalP99.get();
+
+  s.staticSamples = staticCount;
+  if (staticCount > 1)
+    s.jitterRMS = std::sqrt((staticM2[0] + staticM2[1] + staticM2[2]) / (staticCount - 1));
+
+  // the current period counts once it is long enough
+  long long degrees = pooledDegrees;
+  double m2 = pooledM2;
+  if (staticCount >= minStaticSamples)
+    {
+    degrees += staticCount - 1;
+    m2 += staticM2[0] + staticM2[1] + staticM2[2];
+    }
+  if (degrees > 0)
+    {
+    s.pooledJitterRMS = std::sqrt(m2 / degrees);
+    s.pooledSigma = std::sqrt(m2 / (3.0 * degrees));
+    }
+  s.pooledSamples = degrees;
+
+  return s;
+}
+
+
+void writeToolStatisticsCSV(std::ostream &os, const std::vector<std::string> &names,
+  const std::vector<toolStatistics::summary> &stats)
+{
+  os << "tool,samples,ok,missing,out_of_volume,out_of_view,dropouts,sample_rate_hz,"
+    "interval_p50_ms,interval_p95_ms,interval_p99_ms,static_samples,jitter_rms_mm,"
+    "pooled_jitter_rms_mm,pooled_sigma_mm,pooled_samples\n";
+
+  for (size_t i = 0; i < stats.size(); i++)
+    {
+    const toolStatistics::summary &s = stats[i];
+    os << (i < names.size() ? names[i] : std::to_string(i)) << ","
+      << s.samples << "," << s.statusCount[enToolOK] << "," << s.statusCount[enToolMissing] << ","
+      << s.statusCount[enToolOutOfVolume] << "," << s.statusCount[enToolOutOfView] << ","
+      << s.dropouts << "," << s.sampleRateHz << ","
+      << s.intervalP50Ms << "," << s.intervalP95Ms << "," << s.intervalP99Ms << ","
+      << s.staticSamples << "," << s.jitterRMS << ","
+      << s.pooledJitterRMS << "," << s.pooledSigma << "," << s.pooledSamples << "\n";
+    }
+}
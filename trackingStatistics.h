@@ -0,0 +1,161 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: trackingStatistics.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __TRACKINGSTATISTICS_H__
+#define __TRACKINGSTATISTICS_H__
+
+#pragma once
+
+// local includes
+#include "trackerStatusDrawing.h"
+
+// C++ includes
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*!
+* Streaming estimate of one quantile with the P-square algorithm (Jain and
+* Chlamtac, 1985): five markers whose heights are adjusted by piecewise
+* parabolic interpolation, so the memory is constant however many samples
+* are seen.
+*/
+class p2Quantile
+{
+public:
+  explicit p2Quantile(double p = 0.5);
+
+  void reset();
+  void add(double x);
+
+  //! the current estimate (exact for fewer than 5 samples), 0 if there are none
+  double get() const;
+
+  long long getCount() const { return count; }
+
+private:
+  double    p;
+  double    q[5];        // marker heights
+  double    n[5];        // marker positions
+  double    desired[5];  // desired marker positions
+  double    increment[5];
+  long long count;
+};
+
+/*!
+* Tracking-quality statistics of one tool, updated once per tracker sample in
+* constant memory:
+*
+* - counts of samples by status, and dropouts (transitions out of OK)
+* - the sample rate over a sliding window of fixed time buckets
+* - percentiles of the interval between samples
+* - the jitter of the position while the tool is static: Welford mean and
+*   variance, restarted whenever the tool moves away from the running mean.
+*   Static periods of minStaticSamples or more are pooled into an overall
+*   estimate.
+*/
+class toolStatistics
+{
+public:
+  struct summary
+    {
+    long long samples = 0;
+    long long statusCount[enToolStatus_Max] = { 0, 0, 0, 0 };
+    long long dropouts = 0;          // OK -> missing/out of volume/out of view
+    double    sampleRateHz = 0.0;    // over the last windowSeconds
+    double    intervalP50Ms = 0.0, intervalP95Ms = 0.0, intervalP99Ms = 0.0;
+    long long staticSamples = 0;     // in the current static period
+    double    jitterRMS = 0.0;       // RMS 3D distance to the mean position, current static period
+    double    pooledJitterRMS = 0.0; // the same over all static periods so far
+    double    pooledSigma = 0.0;     // per-axis standard deviation over all static periods
+    long long pooledSamples = 0;
+    };
+
+  toolStatistics();
+
+  void reset();
+
+  //! a new sample at time t (seconds); position is only read when status is enToolOK
+  void addSample(double t, enumTrackerToolStatus status, const double position[3]);
+
+  /*!
+  * The statistics at time now, on the clock of the samples. The sample rate
+  * covers the window up to now, so it drops to 0 once the samples stop.
+  */
+  summary getSummary(double now) const;
+
+  //! a move beyond this distance (mm) from the mean position ends a static period
+  static const double motionThreshold;
+  static const int    minStaticSamples = 30;
+  static const int    numRateBuckets = 10;
+  static const double rateBucketSeconds;
+
+private:
+  void poolStaticPeriod();
+
+  // counts
+  long long             samples, statusCount[enToolStatus_Max], dropouts;
+  enumTrackerToolStatus lastStatus;
+
+  // sample rate: ring of per-bucket counts
+  long long             rateBuckets[numRateBuckets];
+  long long             currentBucket;     // index of the bucket of the latest sample
+  double                firstTime, lastTime;
+
+  // intervals between samples, in ms
+  p2Quantile            intervalP50, intervalP95, intervalP99;
+
+  // Welford accumulators of the current static period, and the pooled ones
+  long long             staticCount;
+  double                staticMean[3], staticM2[3];
+  long long             pooledDegrees;     // sum of (n - 1) over pooled periods
+  double                pooledM2;          // sum of M2 over axes and pooled periods
+};
+
+//! write one CSV row per tool, with a header row. names[i] labels stats[i].
+void writeToolStatisticsCSV(std::ostream &os, const std::vector<std::string> &names,
+  const std::vector<toolStatistics::summary> &stats);
+
+#endif // of __TRACKINGSTATISTICS_H__
@@ -0,0 +1,222 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: treEstimator.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "landmarkRegistration.h"
+#include "treEstimator.h"
+
+// VTK includes
+#include <vtkDataSet.h>
+#include <vtkFloatArray.h>
+
+// C++ includes
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+const size_t trialsPerChunk = 250;
+const size_t pointsPerChunk = 16384;
+} // namespace
+
+
+treEstimator::treEstimator(threadPool *sharedPool)
+  : pool(sharedPool), valid(false)
+{
+  if (!pool)
+    {
+    ownPool.reset(new threadPool);
+    pool = ownPool.get();
+    }
+  std::fill(errorMoment, errorMoment + 16, 0.0);
+}
+
+
+double treEstimator::fleSigmaFromFRE(double fre, int n)
+{
+  if (n < 3 || fre < 0.0)
+    return 0.0;
+
+  // FLE^2 is summed over the three axes
+  double fle2 = fre * fre * n / (n - 2.0);
+  return std::sqrt(fle2 / 3.0);
+}
+
+
+bool treEstimator::estimate(const double *source, const double *target, int n, double fleSigma,
+  int numTrials, unsigned int seed)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  valid = false;
+  std::fill(errorMoment, errorMoment + 16, 0.0);
+  if (n < 3 || numTrials <= 0 || fleSigma < 0.0)
+    return false;
+
+  double M0[16];
+  if (landmarkRegistration(source, target, n, M0) < 0.0)
+    return false;
+
+  // per-chunk partial sums, added in chunk order so that the result is reproducible.
+  // Without localization error every trial is M0, so the TRE is 0 and there are no
+  // trials to run (std::normal_distribution requires a positive sigma).
+  size_t nChunks = (fleSigma > 0.0) ? (numTrials + trialsPerChunk - 1) / trialsPerChunk : 0;
+  std::vector< std::array<double, 16> > partial(nChunks);
+
+  pool->parallelFor(nChunks, [&](size_t begin, size_t end)
+    {
+    std::vector<double> perturbed(3 * (size_t)n);
+    for (size_t chunk = begin; chunk < end; chunk++)
+      {
+      std::seed_seq seq{ seed, (unsigned int)chunk };
+      std::mt19937 rng(seq);
+      std::normal_distribution<double> noise(0.0, fleSigma);
+
+      std::array<double, 16> &S = partial[chunk];
+      S.fill(0.0);
+
+      size_t first = chunk * trialsPerChunk;
+      size_t last = std::min(first + trialsPerChunk, (size_t)numTrials);
+      for (size_t k = first; k < last; k++)
+        {
+        for (int i = 0; i < 3 * n; i++)
+          perturbed[i] = target[i] + noise(rng);
+
+        double M[16];
+        landmarkRegistration(source, perturbed.data(), n, M);
+
+        double A[12];
+        for (int i = 0; i < 12; i++)
+          A[i] = M[i] - M0[i];
+        for (int i = 0; i < 4; i++)
+          for (int j = i; j < 4; j++)
+            S[4 * i + j] += A[i] * A[j] + A[4 + i] * A[4 + j] + A[8 + i] * A[8 + j];
+        }
+      }
+    }, 1);
+
+  for (const std::array<double, 16> &S : partial)
+    for (int i = 0; i < 16; i++)
+      errorMoment[i] += S[i];
+  for (int i = 0; i < 4; i++)
+    {
+    for (int j = i; j < 4; j++)
+      {
+      errorMoment[4 * i + j] /= numTrials;
+      errorMoment[4 * j + i] = errorMoment[4 * i + j];
+      }
+    }
+
+  valid = true;
+  stats = statistics();
+  stats.numFiducials = n;
+  stats.numTrials = numTrials;
+  stats.fleSigma = fleSigma;
+  stats.estimateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+  return true;
+}
+
+
+double treEstimator::getTRE(const double p[3]) const
+{
+  const double q[4] = { p[0], p[1], p[2], 1.0 };
+  double e2 = 0.0;
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 4; j++)
+      e2 += q[i] * errorMoment[4 * i + j] * q[j];
+  return std::sqrt(std::max(e2, 0.0));
+}
+
+
+void treEstimator::computeTREMap(vtkDataSet *ds, vtkFloatArray *tre)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  vtkIdType n = ds->GetNumberOfPoints();
+  tre->SetName("TRE");
+  tre->SetNumberOfComponents(1);
+  tre->SetNumberOfTuples(n);
+  float *out = tre->GetPointer(0);
+
+  size_t nChunks = ((size_t)n + pointsPerChunk - 1) / pointsPerChunk;
+  std::vector< std::pair<double, double> > partial(nChunks); // sum, max
+
+  // ds->GetPoint(id, x) only reads, so the points can be visited concurrently
+  pool->parallelFor(nChunks, [&](size_t begin, size_t end)
+    {
+    for (size_t chunk = begin; chunk < end; chunk++)
+      {
+      double sum = 0.0, maxTRE = 0.0, p[3];
+      vtkIdType last = std::min((vtkIdType)((chunk + 1) * pointsPerChunk), n);
+      for (vtkIdType i = (vtkIdType)(chunk * pointsPerChunk); i < last; i++)
+        {
+        ds->GetPoint(i, p);
+        double e = this->getTRE(p);
+        out[i] = (float)e;
+        sum += e;
+        maxTRE = std::max(maxTRE, e);
+        }
+      partial[chunk] = std::make_pair(sum, maxTRE);
+      }
+    }, 1);
+
+  double sum = 0.0, maxTRE = 0.0;
+  for (const std::pair<double, double> &s : partial)
+    {
+    sum += s.first;
+    maxTRE = std::max(maxTRE, s.second);
+    }
+  tre->Modified();
+
+  stats.numTargets = n;
+  stats.meanTRE = n > 0 ? sum / n : 0.0;
+  stats.maxTRE = maxTRE;
+  stats.mapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
@@ -0,0 +1,126 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: treEstimator.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __TREESTIMATOR_H__
+#define __TREESTIMATOR_H__
+
+#pragma once
+
+// local includes
+#include "threadPool.h"
+
+// C++ includes
+#include <memory>
+
+// VTK forward declaration
+class vtkDataSet;
+class vtkFloatArray;
+
+/*!
+* Monte Carlo estimate of the target registration error of a rigid
+* point-based registration (see landmarkRegistration).
+*
+* estimate() perturbs the measured (target) fiducials with isotropic Gaussian
+* noise of the given per-axis standard deviation, re-solves the registration
+* for every trial, and records how far each trial transform M_k deviates from
+* the unperturbed one M_0. With A_k the top three rows of M_k - M_0, the error
+* of trial k at model point p is A_k [p; 1], so
+*
+*   TRE(p)^2 = [p; 1]^T (1/K sum_k A_k^T A_k) [p; 1]
+*
+* Only the 4x4 sum is kept, and getTRE() is O(1) per point. Trials are split
+* into fixed chunks with their own random seed, so the result does not depend
+* on the number of threads.
+*/
+class treEstimator
+{
+public:
+  struct statistics
+    {
+    int     numFiducials = 0;
+    int     numTrials = 0;
+    double  fleSigma = 0.0;     // per-axis standard deviation used, in mm
+    double  estimateMs = 0.0;   // time spent in the trials
+    double  mapMs = 0.0;        // time spent in the last computeTREMap()
+    long long numTargets = 0;   // points in the last map
+    double  meanTRE = 0.0, maxTRE = 0.0;
+    };
+
+  //! run the trials on sharedPool (not owned), or on a pool of its own if nullptr
+  explicit treEstimator(threadPool *sharedPool = nullptr);
+
+  /*!
+  * Per-axis fiducial localization error estimated from the FRE of n
+  * fiducials, using E[FRE^2] = (1 - 2/n) FLE^2 for isotropic FLE.
+  */
+  static double fleSigmaFromFRE(double fre, int n);
+
+  /*!
+  * Run numTrials registrations of source onto target (n interleaved xyz
+  * points, n >= 3) perturbed by fleSigma. A fleSigma of 0 gives a TRE of 0
+  * everywhere. Returns false for invalid input.
+  */
+  bool estimate(const double *source, const double *target, int n, double fleSigma,
+    int numTrials = 20000, unsigned int seed = 1);
+
+  bool isValid() const { return valid; }
+
+  //! RMS TRE at p, in source (model) coordinates
+  double getTRE(const double p[3]) const;
+
+  //! TRE at every point of ds (model coordinates), into a single component array named "TRE"
+  void computeTREMap(vtkDataSet *ds, vtkFloatArray *tre);
+
+  const statistics &getStatistics() const { return stats; }
+
+private:
+  std::unique_ptr<threadPool>  ownPool;          // if no pool was shared
+  threadPool                   *pool;
+  double                       errorMoment[16];  // (1/K) sum_k A_k^T A_k, row-major
+  bool                         valid;
+  statistics                   stats;
+};
+
+#endif // of __TREESTIMATOR_H__
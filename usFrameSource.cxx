@@ -0,0 +1,184 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: usFrameSource.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "poseBuffer.h"
+#include "usFrameSource.h"
+
+// C++ includes
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+
+namespace
+{
+// sleep until poseClockSeconds() reaches t
+void sleepUntil(double t)
+{
+  double dt = t - poseClockSeconds();
+  if (dt > 0.0)
+    std::this_thread::sleep_for(std::chrono::duration<double>(dt));
+}
+} // namespace
+
+
+usSyntheticFrameSource::usSyntheticFrameSource(int w, int h, double rate, int n)
+  : width(w), height(h), numFrames(n), frameCount(0), frameRate(rate), startTime(-1.0),
+  paced(true), seed(2463534242u)
+{
+}
+
+
+bool usSyntheticFrameSource::getProbePose(double timestamp, double m[16])
+{
+  // +/- 40 mm triangle sweep along z with a 4 s period; the image plane is x-y
+  double phase = std::fmod(timestamp - (startTime < 0.0 ? 0.0 : startTime), 4.0) / 4.0;
+  double z = (phase < 0.5) ? -40.0 + 160.0 * phase : 120.0 - 160.0 * phase;
+
+  for (int i = 0; i < 16; i++)
+    m[i] = (i % 5 == 0) ? 1.0 : 0.0;
+  m[7] = -0.05 * height;  // centre the image depth on the sphere
+  m[11] = z;
+
+  return true;
+}
+
+
+bool usSyntheticFrameSource::nextFrame(usFrame &frame)
+{
+  if (numFrames > 0 && frameCount >= numFrames)
+    return false;
+
+  if (startTime < 0.0)
+    startTime = poseClockSeconds();
+
+  // unpaced frames keep their nominal timestamps, so the sweep looks the same
+  frame.timestamp = startTime + frameCount / frameRate;
+  if (paced)
+    sleepUntil(frame.timestamp);
+  frame.width = width;
+  frame.height = height;
+  frame.pixels.resize((size_t)width * height);
+
+  // world position of pixel (i, j) with 0.1 mm pixels, image centred laterally
+  double m[16];
+  this->getProbePose(frame.timestamp, m);
+  double y0 = m[7], z = m[11];
+  const double spacing = 0.1, radius2 = 15.0 * 15.0;
+
+  unsigned char *p = frame.pixels.data();
+  for (int j = 0; j < height; j++)
+    {
+    double y = y0 + j * spacing;
+    for (int i = 0; i < width; i++)
+      {
+      double x = i * spacing - 0.5 * width * spacing;
+      int base = (x*x + y*y + z*z < radius2) ? 200 : 30;
+
+      // xorshift speckle
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      *p++ = (unsigned char)(base + (int)(seed & 31) - 16);
+      }
+    }
+
+  frameCount++;
+  return true;
+}
+
+
+usFileFrameSource::usFileFrameSource(const std::string &fname)
+  : is(fname.c_str(), std::ios::binary), width(0), height(0), numFrames(0), frameCount(0),
+  firstRecordedTime(0.0), replayStartTime(-1.0), valid(false), paced(true)
+{
+  std::string magic;
+  if (is >> magic >> width >> height >> numFrames)
+    {
+    is.get(); // the newline ending the header
+    valid = (magic == "USFRAMES" && width > 0 && height > 0 && numFrames >= 0);
+    }
+}
+
+
+bool usFileFrameSource::nextFrame(usFrame &frame)
+{
+  if (!valid || frameCount >= numFrames)
+    return false;
+
+  // little-endian float64 timestamp
+  unsigned char raw[8];
+  if (!is.read(reinterpret_cast<char *>(raw), 8))
+    return false;
+  uint64_t bits = 0;
+  for (int i = 7; i >= 0; i--)
+    bits = (bits << 8) | raw[i];
+  double recorded;
+  static_assert(sizeof(recorded) == sizeof(bits), "double must be 64 bits");
+  std::memcpy(&recorded, &bits, sizeof(recorded));
+
+  frame.width = width;
+  frame.height = height;
+  frame.pixels.resize((size_t)width * height);
+  if (!is.read(reinterpret_cast<char *>(frame.pixels.data()), (std::streamsize)frame.pixels.size()))
+    return false;
+
+  if (replayStartTime < 0.0)
+    {
+    replayStartTime = poseClockSeconds();
+    firstRecordedTime = recorded;
+    }
+
+  frame.timestamp = replayStartTime + (recorded - firstRecordedTime);
+  if (paced)
+    sleepUntil(frame.timestamp);
+  else
+    frame.timestamp = poseClockSeconds();
+
+  frameCount++;
+  return true;
+}
@@ -0,0 +1,139 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: usFrameSource.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __USFRAMESOURCE_H__
+#define __USFRAMESOURCE_H__
+
+#pragma once
+
+// C++ includes
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//! an 8-bit B-mode ultrasound frame
+struct usFrame
+  {
+  double                      timestamp = 0.0;  // poseClockSeconds()
+  int                         width = 0, height = 0;
+  std::vector<unsigned char>  pixels;           // row-major, row 0 is closest to the transducer
+  };
+
+/*!
+* A stream of 2D ultrasound frames.
+*
+* nextFrame() is called from the acquisition thread and may block until the
+* next frame is due.
+*/
+class usFrameSource
+{
+public:
+  virtual ~usFrameSource() {}
+
+  //! fill frame with the next frame. Returns false at the end of the stream.
+  virtual bool nextFrame(usFrame &frame) = 0;
+
+  /*!
+  * Sources that know the probe pose (e.g. the synthetic sweep) return it here
+  * so that frames can be reconstructed without a tracker.
+  */
+  virtual bool getProbePose(double /*timestamp*/, double /*m*/[16]) { return false; }
+};
+
+/*!
+* Synthetic frames of a 15 mm radius sphere (bright) in a speckled background,
+* imaged by a probe sweeping +/- 40 mm along z every 4 seconds. With the
+* default image-to-probe calibration of usReconstructor (0.1 mm pixels, image
+* centred laterally on the probe), the sphere is reconstructed at the origin.
+*/
+class usSyntheticFrameSource : public usFrameSource
+{
+public:
+  //! numFrames == 0 produces frames until stopped
+  usSyntheticFrameSource(int width = 640, int height = 480, double frameRate = 30.0, int numFrames = 0);
+
+  bool nextFrame(usFrame &frame) override;
+  bool getProbePose(double timestamp, double m[16]) override;
+
+  //! produce frames as fast as possible instead of at frameRate (timestamps stay nominal)
+  void setPaced(bool p) { paced = p; }
+
+private:
+  int       width, height, numFrames, frameCount;
+  double    frameRate, startTime;
+  bool      paced;
+  uint32_t  seed;
+};
+
+/*!
+* Frames recorded in a raw stream file:
+*
+*   USFRAMES <width> <height> <count>\n
+*   followed by count times: float64 timestamp (little endian, seconds) and
+*   width*height 8-bit pixels.
+*
+* Frames are replayed at their recorded rate, with timestamps shifted so that
+* the first frame is stamped with the time replay started.
+*/
+class usFileFrameSource : public usFrameSource
+{
+public:
+  explicit usFileFrameSource(const std::string &fname);
+
+  bool isValid() const { return valid; }
+  bool nextFrame(usFrame &frame) override;
+
+  //! replay as fast as possible instead of at the recorded rate
+  void setPaced(bool p) { paced = p; }
+
+private:
+  std::ifstream is;
+  int           width, height, numFrames, frameCount;
+  double        firstRecordedTime, replayStartTime;
+  bool          valid, paced;
+};
+
+#endif // of __USFRAMESOURCE_H__
@@ -0,0 +1,407 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: usReconstructor.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "usReconstructor.h"
+#include "traceRecorder.h"
+
+// VTK includes
+#include <vtkImageData.h>
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+  // accumulator word: 24-bit hit count above a 40-bit intensity sum. The sum of
+  // 2^24 8-bit pixels fits in 32 bits, so it never carries into the count.
+  const int       hitShift = 40;
+  const uint64_t  sumMask = (uint64_t(1) << hitShift) - 1;
+
+  // the test and the add are not atomic together: leave room for one extra hit
+  // per concurrent insertion thread
+  const uint64_t  maxVoxelHits = (uint64_t(1) << 24) - 4096;
+}
+
+
+usReconstructor::usReconstructor(threadPool *sharedPool)
+  : running(false), acquiring(false), framesReceived(0), framesInserted(0), framesWithoutPose(0),
+  maxQueueLength(0), startTime(0.0), stopTime(0.0)
+{
+  outputPool = sharedPool;
+  if (!outputPool)
+    {
+    ownPool.reset(new threadPool);
+    outputPool = ownPool.get();
+    }
+
+  // 128 mm cube at 0.5 mm, centred on the tracker origin
+  for (int i = 0; i < 3; i++)
+    {
+    origin[i] = -64.0;
+    spacing[i] = 0.5;
+    dims[i] = 256;
+    }
+
+  // 0.1 mm pixels, image centred laterally for 640 columns, depth along probe y
+  const double calib[16] = { 0.1, 0.0, 0.0, -32.0,
+    0.0, 0.1, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0,
+    0.0, 0.0, 0.0, 1.0 };
+  std::copy(calib, calib + 16, imageToProbe);
+}
+
+
+usReconstructor::~usReconstructor()
+{
+  this->stop();
+}
+
+
+void usReconstructor::setOutputGeometry(const double o[3], const double s[3], const int d[3])
+{
+  if (running)
+    return;
+
+  for (int i = 0; i < 3; i++)
+    {
+    origin[i] = o[i];
+    spacing[i] = s[i];
+    dims[i] = d[i];
+    }
+  accumulator.reset();
+}
+
+
+void usReconstructor::setImageToProbeCalibration(const double m[16])
+{
+  if (!running)
+    std::copy(m, m + 16, imageToProbe);
+}
+
+
+void usReconstructor::resetVolume()
+{
+  if (!accumulator)
+    return;
+
+  size_t n = (size_t)dims[0] * dims[1] * dims[2];
+  for (size_t i = 0; i < n; i++)
+    accumulator[i].store(0, std::memory_order_relaxed);
+}
+
+
+void usReconstructor::start(std::unique_ptr<usFrameSource> src, int numThreads)
+{
+  if (running || !src)
+    return;
+
+  if (!accumulator)
+    {
+    accumulator.reset(new std::atomic<uint64_t>[(size_t)dims[0] * dims[1] * dims[2]]);
+    this->resetVolume();
+    }
+
+  if (numThreads <= 0)
+    numThreads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+  source = std::move(src);
+  probePoses.clear();
+  framesReceived = framesInserted = framesWithoutPose = 0;
+  maxQueueLength = 0;
+  startTime = poseClockSeconds();
+
+  running = acquiring = true;
+  acquisitionThread = std::thread(&usReconstructor::acquisitionLoop, this);
+  for (int i = 0; i < numThreads; i++)
+    insertionThreads.emplace_back(&usReconstructor::insertionLoop, this);
+}
+
+
+void usReconstructor::stop()
+{
+  if (!running)
+    return;
+
+  acquiring = false;
+  if (acquisitionThread.joinable())
+    acquisitionThread.join();
+
+  queueChanged.notify_all();
+  for (std::thread &t : insertionThreads)
+    t.join();
+  insertionThreads.clear();
+
+  source.reset();
+  stopTime = poseClockSeconds();
+  running = false;
+}
+
+
+void usReconstructor::acquisitionLoop()
+{
+  traceRecorder::setThreadName("US acquisition");
+  while (acquiring)
+    {
+    usFrame frame;
+    if (!source->nextFrame(frame))
+      break;
+    AIGS_TRACE_SCOPE("usReconstructor::queueFrame");
+
+    double m[16];
+    if (source->getProbePose(frame.timestamp, m))
+      probePoses.addPose(frame.timestamp, m);
+
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      queue.push_back(std::move(frame));
+      maxQueueLength = std::max(maxQueueLength, (int)queue.size());
+    }
+    framesReceived++;
+    queueChanged.notify_one();
+    }
+
+  // end of stream or stop(): let the insertion threads drain the queue and exit
+  acquiring = false;
+  queueChanged.notify_all();
+}
+
+
+void usReconstructor::insertionLoop()
+{
+  traceRecorder::setThreadName("US insertion");
+  for (;;)
+    {
+    usFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queueChanged.wait(lock, [this] { return !queue.empty() || !acquiring; });
+      if (queue.empty())
+        return;
+      frame = std::move(queue.front());
+      queue.pop_front();
+    }
+
+    // the tracker may lag the frame grabber: wait briefly for a pose past the frame
+    double m[16];
+    bool matched = probePoses.getPose(frame.timestamp, m);
+    double deadline = poseClockSeconds() + 0.2;
+    while (!matched && acquiring && probePoses.getLatestTime() < frame.timestamp &&
+      poseClockSeconds() < deadline)
+      {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      matched = probePoses.getPose(frame.timestamp, m);
+      }
+
+    if (matched)
+      {
+      this->insertFrame(frame, m);
+      framesInserted++;
+      }
+    else
+      {
+      framesWithoutPose++;
+      }
+    }
+}
+
+
+void usReconstructor::insertFrame(const usFrame &frame, const double P[16])
+{
+  AIGS_TRACE_SCOPE("usReconstructor::insertFrame");
+  // pixel -> tracker: P * imageToProbe; then tracker -> continuous voxel index
+  double A[3][4];
+  for (int r = 0; r < 3; r++)
+    {
+    for (int c = 0; c < 4; c++)
+      {
+      double v = 0.0;
+      for (int k = 0; k < 4; k++)
+        v += P[4 * r + k] * imageToProbe[4 * k + c];
+      A[r][c] = v;
+      }
+    A[r][3] -= origin[r];
+    for (int c = 0; c < 4; c++)
+      A[r][c] /= spacing[r];
+    }
+
+  const double hi[3] = { dims[0] - 0.5, dims[1] - 0.5, dims[2] - 0.5 };
+  const size_t sliceSize = (size_t)dims[0] * dims[1];
+  const unsigned char *pixel = frame.pixels.data();
+
+  for (int j = 0; j < frame.height; j++)
+    {
+    double p[3] = { A[0][1] * j + A[0][3], A[1][1] * j + A[1][3], A[2][1] * j + A[2][3] };
+    for (int i = 0; i < frame.width; i++, pixel++)
+      {
+      if (p[0] >= -0.5 && p[0] < hi[0] && p[1] >= -0.5 && p[1] < hi[1] && p[2] >= -0.5 && p[2] < hi[2])
+        {
+        size_t idx = (size_t)(p[0] + 0.5) + (size_t)(p[1] + 0.5) * dims[0] + (size_t)(p[2] + 0.5) * sliceSize;
+        std::atomic<uint64_t> &voxel = accumulator[idx];
+        if ((voxel.load(std::memory_order_relaxed) >> hitShift) < maxVoxelHits)
+          voxel.fetch_add((uint64_t(1) << hitShift) | *pixel, std::memory_order_relaxed);
+        }
+      p[0] += A[0][0];
+      p[1] += A[1][0];
+      p[2] += A[2][0];
+      }
+    }
+}
+
+
+void usReconstructor::updateOutput(vtkImageData *out)
+{
+  AIGS_TRACE_SCOPE("usReconstructor::updateOutput");
+  if (!accumulator)
+    return;
+
+  out->SetOrigin(origin);
+  out->SetSpacing(spacing);
+  out->SetDimensions(dims);
+
+  // reuses the scalar array unless a render snapshot still shares it
+  out->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+
+  unsigned char *dst = static_cast<unsigned char *>(out->GetScalarPointer());
+  const std::atomic<uint64_t> *acc = accumulator.get();
+  const int nx = dims[0], ny = dims[1], nz = dims[2];
+  const size_t sliceSize = (size_t)nx * ny;
+  rowHasHits.assign((size_t)ny * nz, 0);
+
+  // pass 1: average the voxels that were hit, and flag the rows that hold any
+  outputPool->parallelFor(nz, [&](size_t zBegin, size_t zEnd)
+    {
+    for (size_t z = zBegin; z < zEnd; z++)
+      {
+      for (int y = 0; y < ny; y++)
+        {
+        size_t idx = z * sliceSize + (size_t)y * nx;
+        bool anyHit = false;
+        for (int x = 0; x < nx; x++, idx++)
+          {
+          uint64_t a = acc[idx].load(std::memory_order_relaxed);
+          uint32_t hits = (uint32_t)(a >> hitShift);
+          dst[idx] = hits ? (unsigned char)((a & sumMask) / hits) : 0;
+          anyHit = anyHit || hits;
+          }
+        rowHasHits[z * ny + y] = anyHit;
+        }
+      }
+    }, 4);
+
+  // pass 2: fill holes from their 3x3x3 neighbourhood. Rows with no hit rows
+  // around them stay empty, so only the neighbourhood of the sweep is visited.
+  outputPool->parallelFor(nz, [&](size_t zBegin, size_t zEnd)
+    {
+    for (int z = (int)zBegin; z < (int)zEnd; z++)
+      {
+      for (int y = 0; y < ny; y++)
+        {
+        bool nearHits = false;
+        for (int dz = -1; dz <= 1 && !nearHits; dz++)
+          for (int dy = -1; dy <= 1 && !nearHits; dy++)
+            if (z + dz >= 0 && z + dz < nz && y + dy >= 0 && y + dy < ny)
+              nearHits = rowHasHits[(size_t)(z + dz) * ny + y + dy] != 0;
+        if (!nearHits)
+          continue;
+
+        size_t idx = z * sliceSize + (size_t)y * nx;
+        for (int x = 0; x < nx; x++, idx++)
+          {
+          if (acc[idx].load(std::memory_order_relaxed) >> hitShift)
+            continue;
+
+          double sum = 0.0;
+          int count = 0;
+          for (int dz = -1; dz <= 1; dz++)
+            {
+            if (z + dz < 0 || z + dz >= nz)
+              continue;
+            for (int dy = -1; dy <= 1; dy++)
+              {
+              if (y + dy < 0 || y + dy >= ny || !rowHasHits[(size_t)(z + dz) * ny + y + dy])
+                continue;
+              for (int dx = -1; dx <= 1; dx++)
+                {
+                if (x + dx < 0 || x + dx >= nx)
+                  continue;
+                uint64_t b = acc[idx + dx + (ptrdiff_t)dy * nx + (ptrdiff_t)dz * sliceSize].load(std::memory_order_relaxed);
+                uint32_t h = (uint32_t)(b >> hitShift);
+                if (h)
+                  {
+                  sum += (double)(b & sumMask) / h;
+                  count++;
+                  }
+                }
+              }
+            }
+          if (count)
+            dst[idx] = (unsigned char)(sum / count + 0.5);
+          }
+        }
+      }
+    }, 4);
+
+  out->Modified();
+}
+
+
+usReconstructor::statistics usReconstructor::getStatistics()
+{
+  statistics s;
+  s.framesReceived = framesReceived;
+  s.framesInserted = framesInserted;
+  s.framesWithoutPose = framesWithoutPose;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    s.queueLength = (int)queue.size();
+    s.maxQueueLength = maxQueueLength;
+  }
+
+  double elapsed = (running ? poseClockSeconds() : stopTime) - startTime;
+  s.insertionFPS = elapsed > 0.0 ? s.framesInserted / elapsed : 0.0;
+  return s;
+}
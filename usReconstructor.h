@@ -0,0 +1,167 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: usReconstructor.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __USRECONSTRUCTOR_H__
+#define __USRECONSTRUCTOR_H__
+
+#pragma once
+
+// local includes
+#include "poseBuffer.h"
+#include "threadPool.h"
+#include "usFrameSource.h"
+
+// C++ includes
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// VTK forward declaration
+class vtkImageData;
+
+/*!
+* Freehand 3D ultrasound reconstruction.
+*
+* An acquisition thread pulls frames from a usFrameSource and queues them;
+* a pool of insertion threads matches each frame to the probe pose at its
+* timestamp (see poseBuffer) and compounds its pixels into the volume by
+* nearest-voxel averaging. Voxel sums and hit counts are packed into one
+* 64-bit atomic per voxel, so frames are inserted concurrently without locks.
+* A voxel saturates after about 16.7M (2^24) hits: later hits are ignored,
+* which leaves its average unchanged.
+* The queue is unbounded: frames are never dropped, and the high-water mark
+* shows whether insertion keeps up.
+*
+* updateOutput() converts the accumulators into an 8-bit vtkImageData, filling
+* voxels no frame has reached from their 3x3x3 neighbourhood.
+*/
+class usReconstructor
+{
+public:
+  struct statistics
+    {
+    long long framesReceived = 0;   // frames read from the source
+    long long framesInserted = 0;   // frames compounded into the volume
+    long long framesWithoutPose = 0;// frames with no tracked probe pose within tolerance
+    int       queueLength = 0;
+    int       maxQueueLength = 0;
+    double    insertionFPS = 0.0;   // over the lifetime of the reconstruction
+    };
+
+  //! updateOutput() runs on sharedPool (not owned), or on a pool of its own if nullptr
+  explicit usReconstructor(threadPool *sharedPool = nullptr);
+  ~usReconstructor();
+
+  //! output volume geometry, in tracker coordinates. Must be set before start().
+  void setOutputGeometry(const double origin[3], const double spacing[3], const int dims[3]);
+
+  /*!
+  * Row-major 4x4 mapping pixel (column, row, 0) to probe coordinates in mm.
+  * The default assumes 0.1 mm pixels, with the image centred laterally on the
+  * probe origin for a 640 pixel wide image.
+  */
+  void setImageToProbeCalibration(const double m[16]);
+
+  //! the probe poses frames are matched against; fed by the tracker update
+  poseBuffer *getPoseBuffer() { return &probePoses; }
+
+  /*!
+  * Start acquiring from source on numThreads insertion threads (<= 0: one
+  * per core, less one for the acquisition thread).
+  */
+  void start(std::unique_ptr<usFrameSource> source, int numThreads = 0);
+
+  //! stop acquiring; queued frames are still inserted before returning
+  void stop();
+
+  bool isRunning() const { return running; }
+
+  //! false once the source has reached the end of its stream
+  bool isAcquiring() const { return acquiring; }
+
+  //! discard everything compounded so far
+  void resetVolume();
+
+  //! write the compounded, hole-filled volume into out (8-bit scalars)
+  void updateOutput(vtkImageData *out);
+
+  statistics getStatistics();
+
+private:
+  void acquisitionLoop();
+  void insertionLoop();
+  void insertFrame(const usFrame &frame, const double probePose[16]);
+
+  // frame pipeline
+  std::unique_ptr<usFrameSource>  source;
+  std::thread                     acquisitionThread;
+  std::vector<std::thread>        insertionThreads;
+  std::deque<usFrame>             queue;
+  std::mutex                      queueMutex;
+  std::condition_variable         queueChanged;
+  std::atomic<bool>               running, acquiring;
+  poseBuffer                      probePoses;
+
+  // volume
+  double                          origin[3], spacing[3];
+  int                             dims[3];
+  double                          imageToProbe[16];
+  std::unique_ptr< std::atomic<uint64_t>[] > accumulator; // hit count << 40 | intensity sum
+  std::unique_ptr<threadPool>     ownPool;                // if no pool was shared
+  threadPool                      *outputPool;
+  std::vector<unsigned char>      rowHasHits;             // per (y, z) row, used by updateOutput()
+
+  // statistics
+  std::atomic<long long>          framesReceived, framesInserted, framesWithoutPose;
+  int                             maxQueueLength;
+  double                          startTime, stopTime;
+};
+
+#endif // of __USRECONSTRUCTOR_H__
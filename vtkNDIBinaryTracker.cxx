@@ -0,0 +1,214 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: vtkNDIBinaryTracker.cxx,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+// local includes
+#include "vtkNDIBinaryTracker.h"
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+
+namespace
+{
+// as vtkNDITracker
+const int numberOfPorts = 12;
+} // namespace
+
+
+vtkStandardNewMacro(vtkNDIBinaryTracker);
+
+
+vtkNDIBinaryTracker::vtkNDIBinaryTracker()
+{
+  this->SerialDevice = nullptr;
+  this->SetSerialDevice("/dev/ttyUSB0");
+  this->MaximumBaudRate = 1228739;
+  this->VirtualSROMs.resize(numberOfPorts);
+  this->PortHandles.assign(numberOfPorts, -1);
+  this->LastFrames.assign(numberOfPorts, 0);
+  this->SendMatrix = vtkMatrix4x4::New();
+  this->SetNumberOfTools(numberOfPorts);
+}
+
+
+vtkNDIBinaryTracker::~vtkNDIBinaryTracker()
+{
+  if (this->IsTracking())
+    this->StopTracking();
+  this->SendMatrix->Delete();
+  this->SetSerialDevice(nullptr);
+}
+
+
+void vtkNDIBinaryTracker::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  ndiBinaryClient::statistics stats = this->Client.getStatistics();
+  os << indent << "SerialDevice: " << (this->SerialDevice ? this->SerialDevice : "(none)") << "\n";
+  os << indent << "MaximumBaudRate: " << this->MaximumBaudRate << "\n";
+  os << indent << "BaudRate: " << stats.baudRate << "\n";
+  os << indent << "Replies: " << stats.replies << "\n";
+  os << indent << "MeanReplyMs: " << stats.meanReplyMs << "\n";
+}
+
+
+int vtkNDIBinaryTracker::GetBaudRate()
+{
+  return this->Client.isOpen() ? this->Client.getStatistics().baudRate : 0;
+}
+
+
+void vtkNDIBinaryTracker::LoadVirtualSROM(int tool, const char *filename)
+{
+  if (tool < 0 || tool >= numberOfPorts)
+    {
+    vtkErrorMacro(<< "LoadVirtualSROM: tool " << tool << " out of range");
+    return;
+    }
+  if (!ndiBinaryClient::readSROMFile(filename, this->VirtualSROMs[tool]))
+    vtkErrorMacro(<< "LoadVirtualSROM: cannot read " << filename);
+}
+
+
+int vtkNDIBinaryTracker::Probe()
+{
+  if (this->IsTracking())
+    return 1;
+
+  bool found = this->SerialDevice && this->Client.open(this->SerialDevice) && this->Client.initialize();
+  if (!found)
+    vtkErrorMacro(<< "Probe: " << this->Client.getLastError());
+  this->Client.close();
+  return found ? 1 : 0;
+}
+
+
+int vtkNDIBinaryTracker::InternalStartTracking()
+{
+  if (!this->SerialDevice || !this->Client.open(this->SerialDevice) || !this->Client.initialize() ||
+    this->Client.negotiateBaudRate(this->MaximumBaudRate) == 0)
+    {
+    vtkErrorMacro(<< "InternalStartTracking: " << this->Client.getLastError());
+    this->Client.close();
+    return 0;
+    }
+
+  for (int tool = 0; tool < numberOfPorts; tool++)
+    {
+    this->PortHandles[tool] = -1;
+    this->LastFrames[tool] = 0;
+    if (this->VirtualSROMs[tool].empty())
+      continue;
+    this->PortHandles[tool] = this->Client.addVirtualTool(this->VirtualSROMs[tool]);
+    if (this->PortHandles[tool] < 0)
+      vtkErrorMacro(<< "InternalStartTracking: tool " << tool << ": " << this->Client.getLastError());
+    }
+
+  if (!this->Client.startTracking())
+    {
+    vtkErrorMacro(<< "InternalStartTracking: " << this->Client.getLastError());
+    this->Client.close();
+    return 0;
+    }
+  return 1;
+}
+
+
+int vtkNDIBinaryTracker::InternalStopTracking()
+{
+  // the next start re-initializes the system, resetting it with a break if needed
+  this->Client.stopTracking();
+  this->Client.close();
+  return 1;
+}
+
+
+void vtkNDIBinaryTracker::InternalUpdate()
+{
+  if (!this->Client.isOpen())
+    return;
+  if (!this->Client.getTransforms(this->Reply))
+    {
+    vtkErrorMacro(<< "InternalUpdate: " << this->Client.getLastError());
+    return;
+    }
+
+  double timestamp = vtkTimerLog::GetUniversalTime();
+  double matrix[16];
+  for (int tool = 0; tool < numberOfPorts; tool++)
+    {
+    if (this->PortHandles[tool] < 0)
+      continue;
+
+    const ndiHandleTransform *transform = nullptr;
+    for (const ndiHandleTransform &t : this->Reply.handles)
+      if (t.handle == this->PortHandles[tool])
+        transform = &t;
+
+    long flags = 0;
+    if (!transform || transform->status != enHandleValid)
+      {
+      flags |= TR_MISSING;
+      }
+    else
+      {
+      // polled faster than the system measures: no new sample for this tool
+      if (transform->frame == this->LastFrames[tool])
+        continue;
+      this->LastFrames[tool] = transform->frame;
+
+      if (transform->portStatus & enPortOutOfVolume)
+        flags |= TR_OUT_OF_VOLUME;
+      else if (transform->portStatus & enPortPartiallyInVolume)
+        flags |= TR_OUT_OF_VIEW;
+      ndiTransformToMatrix(*transform, matrix);
+      this->SendMatrix->DeepCopy(matrix);
+      }
+
+    this->ToolUpdate(tool, this->SendMatrix, flags, timestamp);
+    }
+}
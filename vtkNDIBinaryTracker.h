@@ -0,0 +1,125 @@
+/*=========================================================================
+
+Program:   basic_qtVTK_AIGS
+Module:    $RCSfile: vtkNDIBinaryTracker.h,v $
+Creator:   Elvis C. S. Chen <chene@robarts.ca>
+Language:  C++
+Author:    $Author: Elvis Chen $
+Date:      $Date: 2018/05/28 12:01:30 $
+Version:   $Revision: 0.99 $
+
+==========================================================================
+
+Copyright (c) Elvis C. S. Chen, elvis.chen@gmail.com
+
+Use, modification and redistribution of the software, in source or
+binary forms, are permitted provided that the following terms and
+conditions are met:
+
+1) Redistribution of the source code, in verbatim or modified
+form, must retain the above copyright notice, this license,
+the following disclaimer, and any notices that refer to this
+license and/or the following disclaimer.
+
+2) Redistribution in binary form must include the above copyright
+notice, a copy of this license and the following disclaimer
+in the documentation or with other materials provided with the
+distribution.
+
+3) Modified copies of the source code must be clearly marked as such,
+and must not be misrepresented as verbatim copies of the source code.
+
+THE COPYRIGHT HOLDERS AND/OR OTHER PARTIES PROVIDE THE SOFTWARE "AS IS"
+WITHOUT EXPRESSED OR IMPLIED WARRANTY INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE.  IN NO EVENT SHALL ANY COPYRIGHT HOLDER OR OTHER PARTY WHO MAY
+MODIFY AND/OR REDISTRIBUTE THE SOFTWARE UNDER THE TERMS OF THIS LICENSE
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA OR DATA BECOMING INACCURATE
+OR LOSS OF PROFIT OR BUSINESS INTERRUPTION) ARISING IN ANY WAY OUT OF
+THE USE OR INABILITY TO USE THE SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGES.
+
+=========================================================================*/
+
+
+#ifndef __VTKNDIBINARYTRACKER_H__
+#define __VTKNDIBINARYTRACKER_H__
+
+#pragma once
+
+#include <vtkTracker.h>
+
+// local includes
+#include "ndiBinaryClient.h"
+
+// C++ includes
+#include <vector>
+
+// VTK forward declaration
+class vtkMatrix4x4;
+
+/*!
+* NDI tracker for high sample rates: a drop-in alternative to vtkNDITracker
+* that talks to the system through ndiBinaryClient. The link is moved to the
+* highest baud rate both sides support (not above MaximumBaudRate) and the
+* tools are read with binary BX replies.
+*
+* Tools are passive tools defined by LoadVirtualSROM(), as with vtkNDITracker.
+* SerialDevice may also be the pseudo-terminal of the ndiEmulator.
+*/
+class vtkNDIBinaryTracker : public vtkTracker
+{
+public:
+  static vtkNDIBinaryTracker *New();
+  vtkTypeMacro(vtkNDIBinaryTracker, vtkTracker);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //! serial device of the system, e.g. /dev/ttyUSB0
+  vtkSetStringMacro(SerialDevice);
+  vtkGetStringMacro(SerialDevice);
+
+  /*!
+  * Highest baud rate to negotiate (default 1228739, the highest of the API).
+  * POSIX hosts only set the standard termios rates, so there the link
+  * actually tops out at 921600.
+  */
+  vtkSetMacro(MaximumBaudRate, int);
+  vtkGetMacro(MaximumBaudRate, int);
+
+  //! the negotiated baud rate while tracking, 0 otherwise
+  int GetBaudRate();
+
+  //! tool definition (.rom) of the passive tool reported as tool
+  void LoadVirtualSROM(int tool, const char *filename);
+
+  //! 1 if the system answers on SerialDevice
+  int Probe() override;
+
+  //! read the latest transformations; called by the tracking thread
+  void InternalUpdate() override;
+
+  ndiBinaryClient::statistics GetStatistics() { return this->Client.getStatistics(); }
+
+protected:
+  vtkNDIBinaryTracker();
+  ~vtkNDIBinaryTracker() override;
+
+  int InternalStartTracking() override;
+  int InternalStopTracking() override;
+
+  char                                      *SerialDevice;
+  int                                       MaximumBaudRate;
+  ndiBinaryClient                           Client;
+  std::vector< std::vector<unsigned char> > VirtualSROMs;   // per tool
+  std::vector<int>                          PortHandles;    // per tool, -1 if none
+  std::vector<unsigned int>                 LastFrames;     // per tool
+  ndiTransformReply                         Reply;
+  vtkMatrix4x4                              *SendMatrix;
+
+private:
+  vtkNDIBinaryTracker(const vtkNDIBinaryTracker&) = delete;
+  void operator=(const vtkNDIBinaryTracker&) = delete;
+};
+
+#endif // of __VTKNDIBINARYTRACKER_H__